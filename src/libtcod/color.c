@@ -745,6 +745,7 @@ void TCOD_color_gen_map(TCOD_color_t* map, int nb_key, const TCOD_color_t* key_c
  *  Perform alpha blending on a single channel.
  */
 static uint8_t alpha_blend_channel(int dst_c, int dst_a, int src_c, int src_a, int out_a) {
+  if (out_a == 0) return 0;  // Both colors are fully transparent.
   return (uint8_t)(((src_c * src_a) + (dst_c * dst_a * (255 - src_a) / 255)) / out_a);
 }
 /**
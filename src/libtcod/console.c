@@ -32,6 +32,7 @@
 #include "console.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "libtcod_int.h"
 #include "utility.h"
@@ -54,6 +55,10 @@ static void TCOD_console_data_free(struct TCOD_Console* con) {
     free(con->tiles);
     con->tiles = NULL;
   }
+  if (con->dirty_rows) {
+    free(con->dirty_rows);
+    con->dirty_rows = NULL;
+  }
 }
 static bool TCOD_console_init_(TCOD_Console* con) {
   con = TCOD_console_validate_(con);
@@ -115,11 +120,88 @@ void TCOD_console_resize_(TCOD_Console* console, int width, int height) {
   if (console->w == width && console->h == height) {
     return;
   }
+  const bool was_tracking = console->dirty_rows != NULL;
   TCOD_console_data_free(console);
   console->w = width;
   console->h = height;
   console->elements = width * height;
   TCOD_console_data_alloc(console);
+  if (was_tracking) {
+    TCOD_console_set_write_tracking(console, true);
+  }
+}
+/**
+ *  Reset the dirty spans of a tracked console to empty.
+ */
+static void TCOD_console_clean_(TCOD_Console* console) {
+  if (!console->dirty_rows) {
+    return;
+  }
+  for (int y = 0; y < console->h; ++y) {
+    console->dirty_rows[y] = (TCOD_ConsoleDirtySpan){console->w, 0};
+  }
+}
+TCOD_Error TCOD_console_set_write_tracking(TCOD_Console* console, bool enable) {
+  console = TCOD_console_validate_(console);
+  if (!console) {
+    TCOD_set_errorv("Console must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (!enable) {
+    free(console->dirty_rows);
+    console->dirty_rows = NULL;
+    return TCOD_E_OK;
+  }
+  if (console->dirty_rows) {
+    return TCOD_E_OK;
+  }
+  console->dirty_rows = malloc(sizeof(*console->dirty_rows) * (console->h > 0 ? console->h : 1));
+  if (!console->dirty_rows) {
+    TCOD_set_errorv("Out of memory.");
+    return TCOD_E_OUT_OF_MEMORY;
+  }
+  TCOD_console_clean_(console);
+  TCOD_console_mark_dirty(console, 0, 0, console->w, console->h);
+  return TCOD_E_OK;
+}
+void TCOD_console_mark_dirty(TCOD_Console* console, int x, int y, int width, int height) {
+  console = TCOD_console_validate_(console);
+  if (!console || !console->dirty_rows) {
+    return;
+  }
+  const int left = MAX(x, 0);
+  const int right = MIN(x + width, console->w);
+  if (left >= right) {
+    return;
+  }
+  for (int row = MAX(y, 0); row < MIN(y + height, console->h); ++row) {
+    TCOD_ConsoleDirtySpan* span = &console->dirty_rows[row];
+    span->begin = MIN(span->begin, left);
+    span->end = MAX(span->end, right);
+  }
+}
+TCOD_ConsoleDirtySpan TCOD_console_get_redraw_span_(const TCOD_Console* console, const TCOD_Console* cache, int y) {
+  const TCOD_ConsoleDirtySpan everything = {0, console->w};
+  if (!console->dirty_rows || !cache || !cache->dirty_rows || console->dirty_link != cache ||
+      cache->dirty_link != console) {
+    return everything;  // The cache holds something else, so the tracked writes can not be trusted.
+  }
+  const TCOD_ConsoleDirtySpan written = console->dirty_rows[y];
+  const TCOD_ConsoleDirtySpan invalidated = cache->dirty_rows[y];
+  return (TCOD_ConsoleDirtySpan){
+      MAX(MIN(written.begin, invalidated.begin), 0),
+      MIN(MAX(written.end, invalidated.end), console->w),
+  };
+}
+void TCOD_console_end_redraw_(const TCOD_Console* console, TCOD_Console* cache) {
+  // The tracking data is bookkeeping for the renderers and isn't part of the consoles contents.
+  TCOD_Console* source = (TCOD_Console*)console;
+  TCOD_console_clean_(source);
+  source->dirty_link = cache;
+  if (cache) {
+    TCOD_console_clean_(cache);
+    cache->dirty_link = source;
+  }
 }
 int TCOD_console_get_width(const TCOD_Console* con) {
   con = TCOD_console_validate_(con);
@@ -157,14 +239,16 @@ static uint8_t alpha_blend(int src_c, int src_a, int dst_c, int dst_a, int out_a
 }
 /**
  *  A modified lerp operation which can accept RGBA types.
+ *
+ *  `interp` is a fixed point value where 65025 (255 * 255) is 1.0.
  */
 static struct TCOD_ColorRGBA TCOD_console_blit_lerp_(
-    const struct TCOD_ColorRGBA dst, const struct TCOD_ColorRGBA src, float interp) {
+    const struct TCOD_ColorRGBA dst, const struct TCOD_ColorRGBA src, int interp) {
   uint8_t out_a = (uint8_t)(src.a + dst.a * (255 - src.a) / 255);
   if (out_a == 0) {  // This would cause division by zero.
     return dst;  // Ignore alpha compositing and leave dst unchanged.
   }
-  uint8_t src_a = (uint8_t)(src.a * interp);
+  uint8_t src_a = (uint8_t)(src.a * interp / 65025);
   struct TCOD_ColorRGBA out = {
       alpha_blend(src.r, src_a, dst.r, dst.a, out_a),
       alpha_blend(src.g, src_a, dst.g, dst.a, out_a),
@@ -175,19 +259,17 @@ static struct TCOD_ColorRGBA TCOD_console_blit_lerp_(
 }
 /**
  *  Return the tile for a blit operation between src and dst.
+ *
+ *  `fg_alpha` and `bg_alpha` are from 0 to 255.
  */
 static struct TCOD_ConsoleTile TCOD_console_blit_cell_(
     const struct TCOD_ConsoleTile* __restrict src,
     const struct TCOD_ConsoleTile* __restrict dst,
-    float fg_alpha,
-    float bg_alpha,
-    const struct TCOD_ColorRGB* __restrict key_color) {
-  if (key_color && key_color->r == src->bg.r && key_color->g == src->bg.g && key_color->b == src->bg.b) {
-    return *dst;  // Source pixel is transparent.
-  }
-  fg_alpha *= src->fg.a / 255.0f;
-  bg_alpha *= src->bg.a / 255.0f;
-  if (fg_alpha > 254.5f / 255.0f && bg_alpha > 254.5f / 255.0f) {
+    int fg_alpha,
+    int bg_alpha) {
+  fg_alpha *= src->fg.a;  // Fixed point, 65025 is fully opaque.
+  bg_alpha *= src->bg.a;
+  if (fg_alpha * 2 > 255 * 509 && bg_alpha * 2 > 255 * 509) {  // Both are above 254.5 / 255.
     return *src;  // No alpha. Perform a plain copy.
   }
   struct TCOD_ConsoleTile out = *dst;
@@ -203,15 +285,36 @@ static struct TCOD_ConsoleTile TCOD_console_blit_cell_(
     out.fg = TCOD_console_blit_lerp_(out.fg, src->fg, fg_alpha);
   } else {
     /* Pick the glyph based on foreground_alpha. */
-    if (fg_alpha < 0.5f) {
+    if (fg_alpha * 2 < 65025) {
       out.fg = TCOD_console_blit_lerp_(out.fg, out.bg, fg_alpha * 2);
     } else {
       out.ch = src->ch;
-      out.fg = TCOD_console_blit_lerp_(out.bg, src->fg, (fg_alpha - 0.5f) * 2);
+      out.fg = TCOD_console_blit_lerp_(out.bg, src->fg, fg_alpha * 2 - 65025);
     }
   }
   return out;
 }
+/**
+ *  Return true if `tile` is fully opaque and can be copied as is by an opaque blit.
+ */
+static inline bool TCOD_console_blit_is_opaque_(const struct TCOD_ConsoleTile* tile) {
+  return tile->fg.a == 255 && tile->bg.a == 255;
+}
+/**
+ *  Return true if the background of `tile` matches `key_color`, making the tile transparent.
+ */
+static inline bool TCOD_console_blit_is_key_(
+    const struct TCOD_ConsoleTile* tile, const struct TCOD_ColorRGB* __restrict key_color) {
+  return key_color && key_color->r == tile->bg.r && key_color->g == tile->bg.g && key_color->b == tile->bg.b;
+}
+/**
+ *  Convert a blit alpha parameter to an integer from 0 to 255.
+ */
+static int TCOD_console_blit_alpha_(float alpha) {
+  if (!(alpha > 0.0f)) return 0;  // Also catches NaN.
+  if (alpha >= 1.0f) return 255;
+  return (int)(alpha * 255.0f + 0.5f);
+}
 void TCOD_console_blit_key_color(
     const TCOD_Console* __restrict src,
     int xSrc,
@@ -238,24 +341,47 @@ void TCOD_console_blit_key_color(
   if (wSrc <= 0 || hSrc <= 0) {
     return;
   }
-  if (xDst + wSrc < 0 || yDst + hSrc < 0 || xDst >= dst->w || yDst >= dst->h) {
+  // Clip the source region to both consoles once instead of checking every tile.
+  const int x_begin = MAX(MAX(xSrc, 0), xSrc - xDst);
+  const int x_end = MIN(MIN(xSrc + wSrc, src->w), xSrc - xDst + dst->w);
+  const int y_begin = MAX(MAX(ySrc, 0), ySrc - yDst);
+  const int y_end = MIN(MIN(ySrc + hSrc, src->h), ySrc - yDst + dst->h);
+  if (x_begin >= x_end || y_begin >= y_end) {
     return;
   }
-  for (int cx = xSrc; cx < xSrc + wSrc; ++cx) {
-    for (int cy = ySrc; cy < ySrc + hSrc; ++cy) {
-      /* Check if we're outside the dest console. */
-      int dx = cx - xSrc + xDst;
-      int dy = cy - ySrc + yDst;
-      if (!TCOD_console_is_index_valid_(src, cx, cy)) {
-        continue;
+  const int width = x_end - x_begin;
+  const int fg_alpha = TCOD_console_blit_alpha_(foreground_alpha);
+  const int bg_alpha = TCOD_console_blit_alpha_(background_alpha);
+  const bool opaque = fg_alpha == 255 && bg_alpha == 255;
+  for (int cy = y_begin; cy < y_end; ++cy) {
+    const struct TCOD_ConsoleTile* src_row = &src->tiles[cy * src->w + x_begin];
+    struct TCOD_ConsoleTile* dst_row = &dst->tiles[(cy - ySrc + yDst) * dst->w + (x_begin - xSrc + xDst)];
+    if (!opaque) {
+      for (int x = 0; x < width; ++x) {
+        if (TCOD_console_blit_is_key_(&src_row[x], key_color)) continue;  // Source tile is transparent.
+        dst_row[x] = TCOD_console_blit_cell_(&src_row[x], &dst_row[x], fg_alpha, bg_alpha);
+      }
+      continue;
+    }
+    // Opaque blit, copy runs of opaque non-key tiles directly.
+    for (int x = 0; x < width;) {
+      int run_end = x;
+      while (run_end < width && TCOD_console_blit_is_opaque_(&src_row[run_end]) &&
+             !TCOD_console_blit_is_key_(&src_row[run_end], key_color)) {
+        ++run_end;
       }
-      if (!TCOD_console_is_index_valid_(dst, dx, dy)) {
+      if (run_end > x) {
+        memmove(&dst_row[x], &src_row[x], sizeof(*dst_row) * (run_end - x));  // Runs can overlap in self-blits.
+        x = run_end;
         continue;
       }
-      dst->tiles[dy * dst->w + dx] = TCOD_console_blit_cell_(
-          &src->tiles[cy * src->w + cx], &dst->tiles[dy * dst->w + dx], foreground_alpha, background_alpha, key_color);
+      if (!TCOD_console_blit_is_key_(&src_row[x], key_color)) {
+        dst_row[x] = TCOD_console_blit_cell_(&src_row[x], &dst_row[x], fg_alpha, bg_alpha);
+      }
+      ++x;
     }
   }
+  TCOD_console_mark_dirty(dst, x_begin - xSrc + xDst, y_begin - ySrc + yDst, width, y_end - y_begin);
 }
 void TCOD_console_blit(
     const TCOD_Console* __restrict src,
@@ -291,6 +417,7 @@ void TCOD_console_put_char(TCOD_Console* con, int x, int y, int c, TCOD_bkgnd_fl
     return;
   }
   con->tiles[y * con->w + x].ch = c;
+  TCOD_console_touch_(con, x, y);
   TCOD_console_set_char_foreground(con, x, y, con->fore);
   TCOD_console_set_char_background(con, x, y, con->back, flag);
 }
@@ -300,6 +427,7 @@ void TCOD_console_put_char_ex(TCOD_console_t con, int x, int y, int c, TCOD_colo
     return;
   }
   con->tiles[y * con->w + x].ch = c;
+  TCOD_console_touch_(con, x, y);
   TCOD_console_set_char_foreground(con, x, y, fore);
   TCOD_console_set_char_background(con, x, y, back, TCOD_BKGND_SET);
 }
@@ -316,6 +444,7 @@ void TCOD_console_clear(TCOD_console_t con) {
   for (int i = 0; i < con->elements; ++i) {
     con->tiles[i] = fill;
   }
+  TCOD_console_mark_dirty(con, 0, 0, con->w, con->h);
 }
 TCOD_color_t TCOD_console_get_char_background(const TCOD_Console* con, int x, int y) {
   con = TCOD_console_validate_(con);
@@ -331,6 +460,7 @@ void TCOD_console_set_char_foreground(TCOD_Console* con, int x, int y, TCOD_colo
   if (!TCOD_console_is_index_valid_(con, x, y)) {
     return;
   }
+  TCOD_console_touch_(con, x, y);
   struct TCOD_ColorRGBA* out = &con->tiles[y * con->w + x].fg;
   out->r = col.r;
   out->g = col.g;
@@ -395,78 +525,159 @@ static int channel_overlay(uint8_t dst, uint8_t src) {
   //                        : white - 2*(white-curbk)*(white-oldbk)
   return ((int)src <= 128 ? 2 * (int)src * (int)dst / 255 : 255 - 2 * (255 - (int)src) * (255 - (int)dst) / 255);
 }
-void TCOD_console_set_char_background(TCOD_Console* con, int x, int y, TCOD_color_t col, TCOD_bkgnd_flag_t flag) {
-  con = TCOD_console_validate_(con);
-  if (!TCOD_console_is_index_valid_(con, x, y)) {
-    return;
-  }
-  struct TCOD_ColorRGBA* bg = &con->tiles[y * con->w + x].bg;
-  if (flag == TCOD_BKGND_DEFAULT) {
-    flag = con->bkgnd_flag;
+/**
+ *  Blend a color lambda over a row of tiles.
+ *
+ *  The lambda is always a constant so that compilers can inline it and vectorize each mode separately.
+ */
+static inline void blend_row_(
+    struct TCOD_ConsoleTile* __restrict tiles,
+    int width,
+    const struct TCOD_ColorRGB* __restrict colors,
+    int color_step,
+    int (*lambda)(uint8_t, uint8_t)) {
+  for (int x = 0; x < width; ++x) {
+    tiles[x].bg = blend_color_(&tiles[x].bg, &colors[x * color_step], lambda);
   }
-  uint8_t alpha = (flag >> 8) & 0xFF;
+}
+/**
+ *  Blend colors onto the backgrounds of a row of tiles.
+ *
+ *  `color_step` is 0 to blend a single color over every tile, or 1 to use one color per tile.
+ *  `flag` must not be TCOD_BKGND_DEFAULT.
+ */
+static void TCOD_console_blend_row_(
+    struct TCOD_ConsoleTile* __restrict tiles,
+    int width,
+    const struct TCOD_ColorRGB* __restrict colors,
+    int color_step,
+    TCOD_bkgnd_flag_t flag) {
+  const int alpha = (flag >> 8) & 0xFF;
   switch (flag & 0xff) {
     case TCOD_BKGND_SET:
-      bg->r = col.r;
-      bg->g = col.g;
-      bg->b = col.b;
+      for (int x = 0; x < width; ++x) {
+        const struct TCOD_ColorRGB col = colors[x * color_step];
+        tiles[x].bg.r = col.r;
+        tiles[x].bg.g = col.g;
+        tiles[x].bg.b = col.b;
+      }
       break;
     case TCOD_BKGND_MULTIPLY:
-      *bg = blend_color_(bg, &col, channel_multiply);
+      blend_row_(tiles, width, colors, color_step, channel_multiply);
       break;
     case TCOD_BKGND_LIGHTEN:
-      *bg = blend_color_(bg, &col, channel_lighten);
+      blend_row_(tiles, width, colors, color_step, channel_lighten);
       break;
     case TCOD_BKGND_DARKEN:
-      *bg = blend_color_(bg, &col, channel_darken);
+      blend_row_(tiles, width, colors, color_step, channel_darken);
       break;
     case TCOD_BKGND_SCREEN:
       // newbk = white - (white - oldbk) * (white - curbk)
-      *bg = blend_color_(bg, &col, channel_screen);
+      blend_row_(tiles, width, colors, color_step, channel_screen);
       break;
     case TCOD_BKGND_COLOR_DODGE:
       // newbk = curbk / (white - oldbk)
-      *bg = blend_color_(bg, &col, channel_color_dodge);
+      blend_row_(tiles, width, colors, color_step, channel_color_dodge);
       break;
     case TCOD_BKGND_COLOR_BURN:
       // newbk = white - (white - oldbk) / curbk
-      *bg = blend_color_(bg, &col, channel_color_burn);
+      blend_row_(tiles, width, colors, color_step, channel_color_burn);
       break;
     case TCOD_BKGND_ADD:
       // newbk = oldbk + curbk
-      *bg = blend_color_(bg, &col, channel_add);
+      blend_row_(tiles, width, colors, color_step, channel_add);
       break;
     case TCOD_BKGND_ADDA:
       // newbk = oldbk + alpha * curbk
-      bg->r = clamp_color_((int)bg->r + alpha * (int)col.r / 255);
-      bg->g = clamp_color_((int)bg->g + alpha * (int)col.g / 255);
-      bg->b = clamp_color_((int)bg->b + alpha * (int)col.b / 255);
+      for (int x = 0; x < width; ++x) {
+        const struct TCOD_ColorRGB col = colors[x * color_step];
+        struct TCOD_ColorRGBA* bg = &tiles[x].bg;
+        bg->r = clamp_color_((int)bg->r + alpha * (int)col.r / 255);
+        bg->g = clamp_color_((int)bg->g + alpha * (int)col.g / 255);
+        bg->b = clamp_color_((int)bg->b + alpha * (int)col.b / 255);
+      }
       break;
     case TCOD_BKGND_BURN:
       // newbk = oldbk + curbk - white
-      *bg = blend_color_(bg, &col, channel_burn);
+      blend_row_(tiles, width, colors, color_step, channel_burn);
       break;
     case TCOD_BKGND_OVERLAY:
       // newbk = curbk.x <= 0.5 ? 2*curbk*oldbk
       //                        : white - 2*(white-curbk)*(white-oldbk)
-      *bg = blend_color_(bg, &col, channel_overlay);
+      blend_row_(tiles, width, colors, color_step, channel_overlay);
       break;
-    case TCOD_BKGND_ALPH: {
+    case TCOD_BKGND_ALPH:
       // newbk = (1.0f-alpha)*oldbk + alpha*(curbk-oldbk)
-      struct TCOD_ColorRGBA col_rgba = {col.r, col.g, col.b, alpha};
-      *bg = TCOD_console_blit_lerp_(*bg, col_rgba, 1.0f);
+      for (int x = 0; x < width; ++x) {
+        const struct TCOD_ColorRGB col = colors[x * color_step];
+        const struct TCOD_ColorRGBA col_rgba = {col.r, col.g, col.b, (uint8_t)alpha};
+        tiles[x].bg = TCOD_console_blit_lerp_(tiles[x].bg, col_rgba, 65025);
+      }
       break;
-    }
     default:
       break;
   }
 }
+void TCOD_console_set_char_background(TCOD_Console* con, int x, int y, TCOD_color_t col, TCOD_bkgnd_flag_t flag) {
+  con = TCOD_console_validate_(con);
+  if (!TCOD_console_is_index_valid_(con, x, y)) {
+    return;
+  }
+  TCOD_console_touch_(con, x, y);
+  if (flag == TCOD_BKGND_DEFAULT) {
+    flag = con->bkgnd_flag;
+  }
+  TCOD_console_blend_row_(&con->tiles[y * con->w + x], 1, &col, 0, flag);
+}
+TCOD_Error TCOD_console_blend_rect(
+    TCOD_Console* __restrict console,
+    int x,
+    int y,
+    int width,
+    int height,
+    const TCOD_ColorRGB* __restrict colors,
+    int colors_pitch,
+    TCOD_bkgnd_flag_t flag) {
+  console = TCOD_console_validate_(console);
+  if (!console) {
+    TCOD_set_errorv("Console pointer must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (!colors) {
+    TCOD_set_errorv("Colors must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (colors_pitch < 0 || (colors_pitch > 0 && colors_pitch < width)) {
+    TCOD_set_errorvf("Colors pitch must be 0 or at least the width of the rectangle, but got %i.", colors_pitch);
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (flag == TCOD_BKGND_DEFAULT) {
+    flag = console->bkgnd_flag;
+  }
+  const int x_begin = MAX(x, 0);
+  const int x_end = MIN(x + width, console->w);
+  const int y_begin = MAX(y, 0);
+  const int y_end = MIN(y + height, console->h);
+  if (x_begin >= x_end || y_begin >= y_end) {
+    return TCOD_E_OK;
+  }
+  const int color_step = colors_pitch ? 1 : 0;
+  for (int console_y = y_begin; console_y < y_end; ++console_y) {
+    const TCOD_ColorRGB* row_colors =
+        colors_pitch ? &colors[(console_y - y) * colors_pitch + (x_begin - x)] : colors;
+    TCOD_console_blend_row_(
+        &console->tiles[console_y * console->w + x_begin], x_end - x_begin, row_colors, color_step, flag);
+  }
+  TCOD_console_mark_dirty(console, x_begin, y_begin, x_end - x_begin, y_end - y_begin);
+  return TCOD_E_OK;
+}
 void TCOD_console_set_char(TCOD_console_t con, int x, int y, int c) {
   con = TCOD_console_validate_(con);
   if (!TCOD_console_is_index_valid_(con, x, y)) {
     return;
   }
   con->tiles[y * con->w + x].ch = c;
+  TCOD_console_touch_(con, x, y);
 }
 void TCOD_console_set_default_foreground(TCOD_Console* con, TCOD_color_t col) {
   con = TCOD_console_validate_(con);
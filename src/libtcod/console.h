@@ -100,6 +100,19 @@ typedef struct TCOD_ConsoleTile {
    */
   TCOD_ColorRGBA bg;
 } TCOD_ConsoleTile;
+/***************************************************************************
+    @brief A half-open range of columns `[begin, end)` on a console row which were written to.
+
+    The span is empty when `begin >= end`.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+typedef struct TCOD_ConsoleDirtySpan {
+  int begin;
+  int end;
+} TCOD_ConsoleDirtySpan;
 /***************************************************************************
     @brief A libtcod console containing a grid of tiles with `{ch, fg, bg}` information.
 
@@ -137,6 +150,9 @@ struct TCOD_Console {
    */
   void clear(const TCOD_ConsoleTile& tile = {0x20, {255, 255, 255, 255}, {0, 0, 0, 255}}) noexcept {
     for (auto& it : *this) it = tile;
+    if (dirty_rows) {
+      for (int y = 0; y < h; ++y) dirty_rows[y] = {0, w};
+    }
   }
   /***************************************************************************
       @brief Return a reference to the tile at `xy`.
@@ -238,6 +254,19 @@ struct TCOD_Console {
   void* userdata;
   /** Internal use. */
   void (*on_delete)(struct TCOD_Console* self);
+  /**
+      @brief Per-row spans of columns written since the last render, or NULL if write tracking is disabled.
+
+      When not NULL this array has `h` elements.
+      Direct writes to `tiles` must be reported with `TCOD_console_mark_dirty` while tracking is enabled.
+
+      \rst
+      .. versionadded:: Unreleased
+      \endrst
+   */
+  TCOD_ConsoleDirtySpan* dirty_rows;
+  /** Internal use.  Links a tracked console and the renderer cache it was last drawn onto, in both directions. */
+  const struct TCOD_Console* dirty_link;
 };
 typedef struct TCOD_Console TCOD_Console;
 typedef struct TCOD_Console* TCOD_console_t;
@@ -335,6 +364,39 @@ TCOD_PUBLIC void TCOD_console_clear(TCOD_Console* con);
  */
 TCOD_PUBLIC void TCOD_console_set_char_background(
     TCOD_Console* con, int x, int y, TCOD_color_t col, TCOD_bkgnd_flag_t flag);
+/***************************************************************************
+    @brief Blend background colors over a rectangle of a console using a single blend mode.
+
+    @param console A pointer to a console, or NULL for the root console.
+    @param x The left-most position of the rectangle.
+    @param y The top-most position of the rectangle.
+    @param width The width of the rectangle.
+    @param height The height of the rectangle.
+    @param colors Either a single color or a row-major array of colors, depending on `colors_pitch`.
+    @param colors_pitch The number of colors per row in `colors`, or 0 to blend a single color over the whole rectangle.
+    @param flag The blend mode to use.
+    @return A negative error value on failure.
+
+    This has the same effect as calling `TCOD_console_set_char_background` on every tile of the rectangle,
+    but the blend mode is only dispatched once instead of once per tile.
+    Use this for full screen effects such as lighting, tints, and fog-of-war.
+
+    The rectangle is clipped to the console.
+    When `colors_pitch` is not 0 the first color of `colors` belongs to the top-left corner of the unclipped rectangle.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_console_blend_rect(
+    TCOD_Console* __restrict console,
+    int x,
+    int y,
+    int width,
+    int height,
+    const TCOD_ColorRGB* __restrict colors,
+    int colors_pitch,
+    TCOD_bkgnd_flag_t flag);
 /**
  *  Change the foreground color of a console tile.
  *
@@ -457,6 +519,42 @@ TCOD_PUBLIC TCOD_NODISCARD uint8_t TCOD_console_get_fade(void);
  *  \return The current fading color.
  */
 TCOD_PUBLIC TCOD_NODISCARD TCOD_color_t TCOD_console_get_fading_color(void);
+/***************************************************************************
+    @brief Enable or disable write tracking on a console.
+
+    @param console A pointer to a console, or NULL for the root console.
+    @param enable If true then writes made through the console functions are recorded in `dirty_rows`.
+    @return A negative error value on failure.
+
+    While tracking is enabled renderers only compare and redraw the rows and columns which were written to since the
+    last time the console was presented, instead of comparing every tile against their cache.
+    All libtcod drawing, printing, and blitting functions record their writes.
+    Any code which writes to `tiles` directly must call `TCOD_console_mark_dirty` for the affected region,
+    otherwise the renderer may skip those changes.
+
+    Tracking starts with the entire console marked as dirty.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_console_set_write_tracking(TCOD_Console* console, bool enable);
+/***************************************************************************
+    @brief Mark a region of a console as modified so that it will be redrawn.
+
+    @param console A pointer to a console, or NULL for the root console.
+    @param x The left edge of the region.
+    @param y The top edge of the region.
+    @param width The width of the region.
+    @param height The height of the region.
+
+    The region is clipped to the console.  This does nothing if write tracking is disabled.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC void TCOD_console_mark_dirty(TCOD_Console* console, int x, int y, int width, int height);
 void TCOD_console_resize_(TCOD_Console* console, int width, int height);
 #ifdef __cplusplus
 }  // extern "C"
@@ -1908,7 +1908,7 @@ class TCODLIB_API TCODConsole {
 
   virtual ~TCODConsole();
 
-  [[deprecated("This function does nothing.")]] void setDirty(int x, int y, int w, int h);
+  [[deprecated("Use TCOD_console_mark_dirty instead.")]] void setDirty(int x, int y, int w, int h);
 
   // This conversion may be unsafe.
   TCODConsole(TCOD_Console* console) : data{console} {}
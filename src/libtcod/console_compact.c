@@ -0,0 +1,293 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice and the libtcod contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "console_compact.h"
+
+#include <stb_ds.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "libtcod_int.h"
+#include "utility.h"
+
+#define TCOD_COMPACT_PALETTE_SIZE 256
+#define TCOD_COMPACT_GLYPH_LIMIT 65536
+
+/**
+    A tile which references a console's codepoint table and palette.
+ */
+struct TCOD_CompactTile {
+  uint16_t glyph;  // Index of `TCOD_CompactConsole::glyphs`.
+  uint8_t fg;  // Index of `TCOD_CompactConsole::palette`.
+  uint8_t bg;
+};
+struct TCOD_CompactConsole {
+  int w;
+  int h;
+  struct TCOD_CompactTile* tiles;  // Row-major tiles, `w * h` elements.
+  int palette_count;
+  TCOD_ColorRGBA palette[TCOD_COMPACT_PALETTE_SIZE];
+  int* glyphs;  // stb_ds array of codepoints.
+  struct {
+    uint32_t key;  // Packed RGBA color.
+    uint8_t value;
+  }* palette_lookup;  // stb_ds hash map of palette indexes.
+  struct {
+    int key;  // Codepoint.
+    uint16_t value;
+  }* glyph_lookup;  // stb_ds hash map of glyph indexes.
+};
+/// Pack `color` into a palette lookup key.
+static uint32_t compact_color_key_(TCOD_ColorRGBA color) {
+  return (uint32_t)color.r | ((uint32_t)color.g << 8) | ((uint32_t)color.b << 16) | ((uint32_t)color.a << 24);
+}
+/**
+    Remove palette colors which are not used by any tile, renumbering the rest.
+
+    `pending` is a tile which is not stored in the console yet, its colors are kept and its indexes are updated too.
+ */
+static void compact_reclaim_palette_(TCOD_CompactConsole* __restrict console, struct TCOD_CompactTile* pending) {
+  bool used[TCOD_COMPACT_PALETTE_SIZE] = {false};
+  const int length = console->w * console->h;
+  for (int i = 0; i < length; ++i) {
+    used[console->tiles[i].fg] = true;
+    used[console->tiles[i].bg] = true;
+  }
+  used[pending->fg] = true;
+  used[pending->bg] = true;
+  uint8_t remap[TCOD_COMPACT_PALETTE_SIZE];
+  int count = 0;
+  hmfree(console->palette_lookup);
+  for (int i = 0; i < console->palette_count; ++i) {
+    if (!used[i]) continue;
+    remap[i] = (uint8_t)count;
+    console->palette[count] = console->palette[i];
+    hmput(console->palette_lookup, compact_color_key_(console->palette[count]), (uint8_t)count);
+    ++count;
+  }
+  console->palette_count = count;
+  for (int i = 0; i < length; ++i) {
+    console->tiles[i].fg = remap[console->tiles[i].fg];
+    console->tiles[i].bg = remap[console->tiles[i].bg];
+  }
+  pending->fg = remap[pending->fg];
+  pending->bg = remap[pending->bg];
+}
+/**
+    Return the palette index for `color`, adding it to the palette if needed.
+
+    When the palette is full the colors no longer used by any tile or by `pending` are removed first, which renumbers
+    the palette, including the indexes of `pending`.  Returns a negative error code if the palette is still full.
+ */
+static int compact_intern_color_(
+    TCOD_CompactConsole* __restrict console, TCOD_ColorRGBA color, struct TCOD_CompactTile* pending) {
+  const uint32_t key = compact_color_key_(color);
+  const ptrdiff_t found = hmgeti(console->palette_lookup, key);
+  if (found >= 0) {
+    return console->palette_lookup[found].value;
+  }
+  if (console->palette_count >= TCOD_COMPACT_PALETTE_SIZE) {
+    compact_reclaim_palette_(console, pending);
+  }
+  if (console->palette_count >= TCOD_COMPACT_PALETTE_SIZE) {
+    TCOD_set_errorvf("Compact console palette is full, it can only hold %i colors.", TCOD_COMPACT_PALETTE_SIZE);
+    return TCOD_E_ERROR;
+  }
+  const int index = console->palette_count++;
+  console->palette[index] = color;
+  hmput(console->palette_lookup, key, (uint8_t)index);
+  return index;
+}
+/**
+    Return the glyph index for codepoint `ch`, adding it to the codepoint table if needed.
+
+    Returns a negative error code if the table is full.
+ */
+static int compact_intern_glyph_(TCOD_CompactConsole* __restrict console, int ch) {
+  const ptrdiff_t found = hmgeti(console->glyph_lookup, ch);
+  if (found >= 0) {
+    return console->glyph_lookup[found].value;
+  }
+  const int index = (int)arrlen(console->glyphs);
+  if (index >= TCOD_COMPACT_GLYPH_LIMIT) {
+    TCOD_set_errorvf("Compact console can not hold more than %i distinct codepoints.", TCOD_COMPACT_GLYPH_LIMIT);
+    return TCOD_E_ERROR;
+  }
+  arrput(console->glyphs, ch);
+  hmput(console->glyph_lookup, ch, (uint16_t)index);
+  return index;
+}
+/**
+    Change the tile at index `i`.  `ch` is ignored if negative, `fg` and `bg` are ignored if NULL.
+ */
+static TCOD_Error compact_store_tile_(
+    TCOD_CompactConsole* __restrict console, int i, int ch, const TCOD_ColorRGBA* fg, const TCOD_ColorRGBA* bg) {
+  struct TCOD_CompactTile tile = console->tiles[i];
+  if (ch >= 0) {
+    const int glyph = compact_intern_glyph_(console, ch);
+    if (glyph < 0) return (TCOD_Error)glyph;
+    tile.glyph = (uint16_t)glyph;
+  }
+  if (fg) {
+    const int index = compact_intern_color_(console, *fg, &tile);
+    if (index < 0) return (TCOD_Error)index;
+    tile.fg = (uint8_t)index;
+  }
+  if (bg) {
+    const int index = compact_intern_color_(console, *bg, &tile);
+    if (index < 0) return (TCOD_Error)index;
+    tile.bg = (uint8_t)index;
+  }
+  console->tiles[i] = tile;
+  return TCOD_E_OK;
+}
+TCOD_CompactConsole* TCOD_compact_console_new(int width, int height) {
+  if (width <= 0 || height <= 0) {
+    TCOD_set_errorvf("Width and height must be greater than zero: got %i,%i", width, height);
+    return NULL;
+  }
+  TCOD_CompactConsole* console = calloc(1, sizeof(*console));
+  if (!console) {
+    TCOD_set_errorv("Out of memory.");
+    return NULL;
+  }
+  console->w = width;
+  console->h = height;
+  console->tiles = malloc(sizeof(*console->tiles) * width * height);
+  if (!console->tiles) {
+    TCOD_set_errorv("Out of memory.");
+    TCOD_compact_console_delete(console);
+    return NULL;
+  }
+  struct TCOD_CompactTile blank = {(uint16_t)compact_intern_glyph_(console, 0x20), 0, 0};
+  blank.fg = (uint8_t)compact_intern_color_(console, (TCOD_ColorRGBA){255, 255, 255, 255}, &blank);
+  blank.bg = (uint8_t)compact_intern_color_(console, (TCOD_ColorRGBA){0, 0, 0, 255}, &blank);
+  for (int i = 0; i < width * height; ++i) {
+    console->tiles[i] = blank;
+  }
+  return console;
+}
+TCOD_CompactConsole* TCOD_compact_console_new_from(const TCOD_Console* src) {
+  src = TCOD_console_validate_(src);
+  if (!src) {
+    TCOD_set_errorv("Console must not be NULL.");
+    return NULL;
+  }
+  TCOD_CompactConsole* console = TCOD_compact_console_new(src->w, src->h);
+  if (!console) {
+    return NULL;
+  }
+  for (int i = 0; i < src->elements; ++i) {
+    if (compact_store_tile_(console, i, src->tiles[i].ch, &src->tiles[i].fg, &src->tiles[i].bg) < 0) {
+      TCOD_compact_console_delete(console);
+      return NULL;
+    }
+  }
+  return console;
+}
+void TCOD_compact_console_delete(TCOD_CompactConsole* console) {
+  if (!console) {
+    return;
+  }
+  hmfree(console->glyph_lookup);
+  hmfree(console->palette_lookup);
+  arrfree(console->glyphs);
+  free(console->tiles);
+  free(console);
+}
+int TCOD_compact_console_get_width(const TCOD_CompactConsole* console) { return console ? console->w : 0; }
+int TCOD_compact_console_get_height(const TCOD_CompactConsole* console) { return console ? console->h : 0; }
+TCOD_Error TCOD_compact_console_put(
+    TCOD_CompactConsole* console, int x, int y, int ch, const TCOD_ColorRGBA* fg, const TCOD_ColorRGBA* bg) {
+  if (!console) {
+    TCOD_set_errorv("Console must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (x < 0 || y < 0 || x >= console->w || y >= console->h) {
+    TCOD_set_errorvf("Position %i,%i is out of bounds.", x, y);
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  return compact_store_tile_(console, y * console->w + x, ch > 0 ? ch : -1, fg, bg);
+}
+TCOD_Error TCOD_compact_console_get(const TCOD_CompactConsole* console, int x, int y, TCOD_ConsoleTile* out) {
+  if (!console || !out) {
+    TCOD_set_errorv("Console and output must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (x < 0 || y < 0 || x >= console->w || y >= console->h) {
+    TCOD_set_errorvf("Position %i,%i is out of bounds.", x, y);
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  const struct TCOD_CompactTile tile = console->tiles[y * console->w + x];
+  *out = (TCOD_ConsoleTile){console->glyphs[tile.glyph], console->palette[tile.fg], console->palette[tile.bg]};
+  return TCOD_E_OK;
+}
+TCOD_Error TCOD_compact_console_blit(
+    const TCOD_CompactConsole* __restrict src,
+    int x_src,
+    int y_src,
+    int width,
+    int height,
+    TCOD_Console* __restrict dst,
+    int x_dst,
+    int y_dst) {
+  dst = TCOD_console_validate_(dst);
+  if (!src || !dst) {
+    TCOD_set_errorv("Source and destination consoles must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (width == 0) {
+    width = src->w;
+  }
+  if (height == 0) {
+    height = src->h;
+  }
+  const int x_begin = MAX(MAX(x_src, 0), x_src - x_dst);
+  const int x_end = MIN(MIN(x_src + width, src->w), x_src - x_dst + dst->w);
+  const int y_begin = MAX(MAX(y_src, 0), y_src - y_dst);
+  const int y_end = MIN(MIN(y_src + height, src->h), y_src - y_dst + dst->h);
+  if (x_begin >= x_end || y_begin >= y_end) {
+    return TCOD_E_OK;
+  }
+  const int* __restrict glyphs = src->glyphs;
+  const TCOD_ColorRGBA* __restrict palette = src->palette;
+  const int row_width = x_end - x_begin;
+  for (int y = y_begin; y < y_end; ++y) {
+    const struct TCOD_CompactTile* __restrict src_row = &src->tiles[y * src->w + x_begin];
+    TCOD_ConsoleTile* __restrict dst_row = &dst->tiles[(y - y_src + y_dst) * dst->w + (x_begin - x_src + x_dst)];
+    for (int x = 0; x < row_width; ++x) {
+      const struct TCOD_CompactTile tile = src_row[x];
+      dst_row[x] = (TCOD_ConsoleTile){glyphs[tile.glyph], palette[tile.fg], palette[tile.bg]};
+    }
+  }
+  TCOD_console_mark_dirty(dst, x_begin - x_src + x_dst, y_begin - y_src + y_dst, row_width, y_end - y_begin);
+  return TCOD_E_OK;
+}
@@ -0,0 +1,144 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice and the libtcod contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LIBTCOD_CONSOLE_COMPACT_H_
+#define LIBTCOD_CONSOLE_COMPACT_H_
+#include "color.h"
+#include "config.h"
+#include "console.h"
+#include "error.h"
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+/**
+    A memory efficient console for very large off-screen maps.
+
+    Each tile uses 4 bytes instead of the 12 bytes of `TCOD_ConsoleTile`: a
+    16-bit index into a table of codepoints and two 8-bit indexes into a shared
+    palette of up to 256 RGBA colors.  Up to 65536 distinct codepoints can be
+    used.  Tiles are expanded to full tiles when blitted onto a normal console.
+
+    The palette limit counts the colors currently used by tiles.  When the
+    palette is full, colors which no tile uses anymore are reclaimed, which
+    scans every tile.  Codepoints are never reclaimed.
+
+    Compact consoles have their own accessors since `TCOD_Console` exposes its
+    tiles directly.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+typedef struct TCOD_CompactConsole TCOD_CompactConsole;
+/**
+    Return a new compact console of `width` by `height` tiles.
+
+    Tiles start as a space with a white foreground and a black background.
+    Returns NULL on error, see `TCOD_get_error`.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_NODISCARD TCOD_CompactConsole* TCOD_compact_console_new(int width, int height);
+/**
+    Return a new compact console with the same size and contents as `console`.
+
+    Returns NULL on error, such as when `console` uses more than 256 colors.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_NODISCARD TCOD_CompactConsole* TCOD_compact_console_new_from(const TCOD_Console* console);
+/**
+    Delete a compact console.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC void TCOD_compact_console_delete(TCOD_CompactConsole* console);
+/**
+    Return the width of a compact console in tiles.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC int TCOD_compact_console_get_width(const TCOD_CompactConsole* console);
+/**
+    Return the height of a compact console in tiles.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC int TCOD_compact_console_get_height(const TCOD_CompactConsole* console);
+/**
+    Change a tile of a compact console.
+
+    `ch` is ignored if it is zero or less, `fg` and `bg` are ignored if they
+    are NULL.  Returns an error if `x`,`y` is out of bounds or if the palette or
+    codepoint table is full.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_compact_console_put(
+    TCOD_CompactConsole* console, int x, int y, int ch, const TCOD_ColorRGBA* fg, const TCOD_ColorRGBA* bg);
+/**
+    Expand the tile at `x`,`y` into `out`.
+
+    Returns an error if `x`,`y` is out of bounds.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_compact_console_get(
+    const TCOD_CompactConsole* console, int x, int y, TCOD_ConsoleTile* out);
+/**
+    Copy a region of a compact console onto a normal console, expanding each tile.
+
+    This works like `TCOD_console_blit` with full opacity.  A `width` or
+    `height` of zero uses the full size of `src`.  The region is clipped to both
+    consoles.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_compact_console_blit(
+    const TCOD_CompactConsole* __restrict src,
+    int x_src,
+    int y_src,
+    int width,
+    int height,
+    TCOD_Console* __restrict dst,
+    int x_dst,
+    int y_dst);
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+#endif  // LIBTCOD_CONSOLE_COMPACT_H_
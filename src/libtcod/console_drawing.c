@@ -71,6 +71,7 @@ void TCOD_console_put_rgb(
   int console_index = y * console->w + x;
   if (ch > 0) {
     console->tiles[console_index].ch = ch;
+    TCOD_console_touch_(console, x, y);
   }
   if (fg) {
     TCOD_console_set_char_foreground(console, x, y, *fg);
@@ -96,10 +97,21 @@ TCOD_Error TCOD_console_draw_rect_rgb(
   }
   clamp_rect_(0, 0, console->w, console->h, &x, &y, &width, &height);
   TCOD_ASSERT(x + width <= console->w && y + height <= console->h);
-  for (int console_y = y; console_y < y + height; ++console_y) {
-    for (int console_x = x; console_x < x + width; ++console_x) {
-      TCOD_console_put_rgb(console, console_x, console_y, ch, fg, bg, flag);
+  if (width <= 0 || height <= 0) {
+    return TCOD_E_OK;
+  }
+  if (ch > 0 || fg) {
+    for (int console_y = y; console_y < y + height; ++console_y) {
+      TCOD_ConsoleTile* row = &console->tiles[console_y * console->w];
+      for (int console_x = x; console_x < x + width; ++console_x) {
+        if (ch > 0) row[console_x].ch = ch;
+        if (fg) row[console_x].fg = (TCOD_ColorRGBA){fg->r, fg->g, fg->b, 255};
+      }
     }
+    TCOD_console_mark_dirty(console, x, y, width, height);
+  }
+  if (bg) {
+    return TCOD_console_blend_rect(console, x, y, width, height, bg, 0, flag);
   }
   return TCOD_E_OK;
 }
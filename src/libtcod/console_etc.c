@@ -94,7 +94,53 @@ TCOD_internal_context_t TCOD_ctx = {
     true,
     NULL,
     NULL,
+    /* fade console */
+    NULL,
 };
+/**
+    Present `console` with the global fading color applied.
+
+    The faded tiles are written to a scratch console which is kept between frames.
+ */
+static TCOD_Error TCOD_console_present_faded_(const TCOD_Console* console, struct TCOD_ViewportOptions* viewport) {
+  if (!TCOD_ctx.fade_console || TCOD_ctx.fade_console->w != console->w || TCOD_ctx.fade_console->h != console->h) {
+    if (TCOD_ctx.fade_console) {
+      TCOD_console_delete(TCOD_ctx.fade_console);
+    }
+    TCOD_ctx.fade_console = TCOD_console_new(console->w, console->h);
+    if (!TCOD_ctx.fade_console) {
+      return TCOD_E_ERROR;
+    }
+  }
+  TCOD_Console* faded = TCOD_ctx.fade_console;
+  const TCOD_ColorRGBA fade_color = {
+      TCOD_ctx.fading_color.r,
+      TCOD_ctx.fading_color.g,
+      TCOD_ctx.fading_color.b,
+      255 - TCOD_ctx.fade,
+  };
+  // Blending onto an opaque color is a plain lerp, the fading color is premultiplied here.
+  const int keep = TCOD_ctx.fade;
+  const int fade_r = fade_color.r * fade_color.a;
+  const int fade_g = fade_color.g * fade_color.a;
+  const int fade_b = fade_color.b * fade_color.a;
+  for (int i = 0; i < console->elements; ++i) {
+    TCOD_ConsoleTile tile = console->tiles[i];
+    if (tile.fg.a == 255 && tile.bg.a == 255) {
+      tile.fg.r = (uint8_t)((tile.fg.r * keep + fade_r) / 255);
+      tile.fg.g = (uint8_t)((tile.fg.g * keep + fade_g) / 255);
+      tile.fg.b = (uint8_t)((tile.fg.b * keep + fade_b) / 255);
+      tile.bg.r = (uint8_t)((tile.bg.r * keep + fade_r) / 255);
+      tile.bg.g = (uint8_t)((tile.bg.g * keep + fade_g) / 255);
+      tile.bg.b = (uint8_t)((tile.bg.b * keep + fade_b) / 255);
+    } else {
+      TCOD_color_alpha_blend(&tile.fg, &fade_color);
+      TCOD_color_alpha_blend(&tile.bg, &fade_color);
+    }
+    faded->tiles[i] = tile;
+  }
+  return TCOD_context_present(TCOD_ctx.engine, faded, viewport);
+}
 TCOD_Error TCOD_console_flush_ex(TCOD_Console* console, struct TCOD_ViewportOptions* viewport) {
   console = TCOD_console_validate_(console);
   if (!console) {
@@ -108,24 +154,7 @@ TCOD_Error TCOD_console_flush_ex(TCOD_Console* console, struct TCOD_ViewportOpti
   if (TCOD_ctx.fade == 255) {
     err = TCOD_context_present(TCOD_ctx.engine, console, viewport);
   } else {
-    // Apply the global fading color before presenting.
-    TCOD_Console* root_copy = TCOD_console_new(TCOD_ctx.root->w, TCOD_ctx.root->h);
-    if (!root_copy) {
-      return TCOD_E_ERROR;
-    }
-    const TCOD_ColorRGBA fade_color = {
-        TCOD_ctx.fading_color.r,
-        TCOD_ctx.fading_color.g,
-        TCOD_ctx.fading_color.b,
-        255 - TCOD_ctx.fade,
-    };
-    for (int i = 0; i < root_copy->elements; ++i) {
-      root_copy->tiles[i] = TCOD_ctx.root->tiles[i];
-      TCOD_color_alpha_blend(&root_copy->tiles[i].fg, &fade_color);
-      TCOD_color_alpha_blend(&root_copy->tiles[i].bg, &fade_color);
-    }
-    err = TCOD_context_present(TCOD_ctx.engine, root_copy, viewport);
-    TCOD_console_delete(root_copy);
+    err = TCOD_console_present_faded_(console, viewport);
   }
 #ifndef NO_SDL
   sync_time_();
@@ -134,14 +163,9 @@ TCOD_Error TCOD_console_flush_ex(TCOD_Console* console, struct TCOD_ViewportOpti
 }
 TCOD_Error TCOD_console_flush(void) { return TCOD_console_flush_ex(NULL, NULL); }
 /**
- *  Manually mark a region of a console as dirty.
+ *  Manually mark a region of the root console as dirty.
  */
-void TCOD_console_set_dirty(int dx, int dy, int dw, int dh) {
-  (void)dx;
-  (void)dy;
-  (void)dw;
-  (void)dh;  // Ignore.
-}
+void TCOD_console_set_dirty(int dx, int dy, int dw, int dh) { TCOD_console_mark_dirty(NULL, dx, dy, dw, dh); }
 /**
  *  \brief Set a font image to be loaded during initialization.
  *
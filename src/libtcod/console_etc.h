@@ -69,7 +69,7 @@ TCOD_DEPRECATED("This function is not compatible with contexts.")
 TCODLIB_API void TCOD_console_map_string_to_font_utf(const wchar_t* s, int fontCharX, int fontCharY);
 #endif
 
-TCOD_DEPRECATED("This function does nothing.")
+TCOD_DEPRECATED("Use TCOD_console_mark_dirty instead.")
 TCODLIB_API void TCOD_console_set_dirty(int x, int y, int w, int h);
 /**
     Render and present a console with optional viewport options.
@@ -134,6 +134,11 @@ int TCOD_sys_accumulate_console_(const TCOD_Console* console, const struct SDL_R
     return -1;
   }
   if (TCOD_ctx.engine && TCOD_ctx.engine->c_accumulate_) {
+    TCOD_context_async_sync_(TCOD_ctx.engine);
+    if (TCOD_ctx.engine->c_request_tiles_) {
+      const TCOD_Error err = TCOD_ctx.engine->c_request_tiles_(TCOD_ctx.engine, console);
+      if (err < 0) return err;
+    }
     return TCOD_ctx.engine->c_accumulate_(TCOD_ctx.engine, console, NULL);
   }
   return -1;
@@ -34,6 +34,7 @@
 #include <ctype.h>
 #include <limits.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -45,6 +46,13 @@
 #ifndef TCOD_NO_UNICODE
 #include <utf8proc.h>
 #endif  // TCOD_NO_UNICODE
+#if !defined(TCOD_NO_UNICODE) && !defined(TCOD_NO_THREADS)
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#endif  // !defined(TCOD_NO_UNICODE) && !defined(TCOD_NO_THREADS)
 
 #include "console.h"
 #include "console_drawing.h"
@@ -735,29 +743,6 @@ int TCOD_console_get_height_rect_utf(TCOD_Console* con, int x, int y, int w, int
 #ifndef TCOD_NO_UNICODE
 // ----------------------------------------------------------------------------
 // New UTF-8 parser.
-/**
- *  Allocates the formatted string to `out` and returns the size.
- *
- *  Returns a negative number on error.
- */
-static int vsprint_(char** out, const char* fmt, va_list ap) {
-  if (!fmt) {
-    return -1;
-  }
-  va_list ap_clone;
-  va_copy(ap_clone, ap);
-  int size = vsnprintf(NULL, 0, fmt, ap_clone);
-  va_end(ap_clone);
-  if (size < 0) {
-    return size;
-  }
-  *out = malloc(size + 1);
-  if (!*out) {
-    return -1;
-  }
-  vsprintf(*out, fmt, ap);
-  return size;
-}
 typedef struct FormattedPrinter {
   const unsigned char* __restrict string;
   const unsigned char* end;
@@ -789,6 +774,13 @@ static TCOD_Error utf8_report_error(utf8proc_ssize_t err) {
  */
 TCOD_NODISCARD
 static TCOD_Error fp_next_raw(FormattedPrinter* __restrict printer, int* __restrict out) {
+  if (printer->string < printer->end && *printer->string < 0x80) {  // ASCII does not need to be decoded.
+    if (out) {
+      *out = *printer->string;
+    }
+    ++printer->string;
+    return TCOD_E_OK;
+  }
   int codepoint;
   utf8proc_ssize_t len = utf8proc_iterate(printer->string, printer->end - printer->string, &codepoint);
   if (len < 0) {
@@ -879,21 +871,45 @@ static TCOD_Error fp_peek(const FormattedPrinter* __restrict printer, int* __res
   FormattedPrinter temp = *printer;
   return fp_next(&temp, out);
 }
-/*
-    Check if the specified character is any line-break character
+/**
+    Flags describing how a codepoint is handled by the print functions.
+ */
+enum CharInfo {
+  CHAR_INFO_WIDTH_MASK = 0x03,  // The tile-width of the codepoint before `TCOD_double_width_print_mode` is applied.
+  CHAR_INFO_SPACE = 0x04,  // Separator, space.
+  CHAR_INFO_DASH = 0x08,  // Punctuation, dash.
+  CHAR_INFO_NEWLINE = 0x10,  // Any line-break character.
+  CHAR_INFO_PARAGRAPH = 0x20,  // Separator, paragraph.
+};
+/**
+    Return the CharInfo flags of a codepoint from utf8proc.
  */
 TCOD_NODISCARD
-static bool is_newline(int codepoint) {
+static uint8_t compute_char_info_(int codepoint) {
   const utf8proc_property_t* property = utf8proc_get_property(codepoint);
+  uint8_t info = (uint8_t)MIN(property->charwidth, 2);
   switch (property->category) {
-    case UTF8PROC_CATEGORY_ZL: /* Separator, line */
-    case UTF8PROC_CATEGORY_ZP: /* Separator, paragraph */
-      return true;
-    case UTF8PROC_CATEGORY_CC: /* Other, control */
+    case UTF8PROC_CATEGORY_CO:  // Private Use Area.
+      info = 1;  // Width would otherwise be zero.
+      break;
+    case UTF8PROC_CATEGORY_ZS:
+      info |= CHAR_INFO_SPACE;
+      break;
+    case UTF8PROC_CATEGORY_PD:
+      info |= CHAR_INFO_DASH;
+      break;
+    case UTF8PROC_CATEGORY_ZL:
+      info |= CHAR_INFO_NEWLINE;
+      break;
+    case UTF8PROC_CATEGORY_ZP:
+      info |= CHAR_INFO_NEWLINE | CHAR_INFO_PARAGRAPH;
+      break;
+    case UTF8PROC_CATEGORY_CC:  // Other, control.
       switch (property->boundclass) {
         case UTF8PROC_BOUNDCLASS_CR:  // carriage return - \r
         case UTF8PROC_BOUNDCLASS_LF:  // line feed - \n
-          return true;
+          info |= CHAR_INFO_NEWLINE;
+          break;
         default:
           break;
       }
@@ -901,7 +917,95 @@ static bool is_newline(int codepoint) {
     default:
       break;
   }
-  return false;
+  return info;
+}
+#define CHAR_INFO_BLOCK_BITS 7
+#define CHAR_INFO_BLOCK_SIZE (1 << CHAR_INFO_BLOCK_BITS)
+#define CHAR_INFO_BLOCK_COUNT (0x10000 >> CHAR_INFO_BLOCK_BITS)
+#define CHAR_INFO_MAX_UNIQUE_BLOCKS 192
+#define CHAR_INFO_NO_BLOCK 0xFF
+/**
+    A two-level table of CharInfo flags for the Basic Multilingual Plane.
+
+    Codepoints are grouped into blocks, identical blocks are only stored once.
+    Blocks which did not fit are marked with CHAR_INFO_NO_BLOCK and fall back to utf8proc.
+ */
+static struct {
+  uint8_t block_index[CHAR_INFO_BLOCK_COUNT];
+  uint8_t blocks[CHAR_INFO_MAX_UNIQUE_BLOCKS][CHAR_INFO_BLOCK_SIZE];
+} char_info_table;
+/**
+    Fill `char_info_table`.  Only call this through `char_info_table_ensure_`.
+ */
+static void char_info_table_init_(void) {
+  int unique_blocks = 0;
+  for (int block = 0; block < CHAR_INFO_BLOCK_COUNT; ++block) {
+    uint8_t data[CHAR_INFO_BLOCK_SIZE];
+    for (int i = 0; i < CHAR_INFO_BLOCK_SIZE; ++i) {
+      data[i] = compute_char_info_((block << CHAR_INFO_BLOCK_BITS) | i);
+    }
+    int found = CHAR_INFO_NO_BLOCK;
+    for (int i = 0; i < unique_blocks; ++i) {
+      if (memcmp(char_info_table.blocks[i], data, sizeof(data)) == 0) {
+        found = i;
+        break;
+      }
+    }
+    if (found == CHAR_INFO_NO_BLOCK && unique_blocks < CHAR_INFO_MAX_UNIQUE_BLOCKS) {
+      memcpy(char_info_table.blocks[unique_blocks], data, sizeof(data));
+      found = unique_blocks++;
+    }
+    char_info_table.block_index[block] = (uint8_t)found;
+  }
+}
+#if defined(TCOD_NO_THREADS)
+static void char_info_table_init_once_(void) {
+  static bool initialized = false;
+  if (initialized) return;
+  char_info_table_init_();
+  initialized = true;
+}
+#elif defined(_WIN32)
+static BOOL CALLBACK char_info_table_init_callback_(PINIT_ONCE once, PVOID parameter, PVOID* context) {
+  (void)once;
+  (void)parameter;
+  (void)context;
+  char_info_table_init_();
+  return TRUE;
+}
+static void char_info_table_init_once_(void) {
+  static INIT_ONCE once = INIT_ONCE_STATIC_INIT;
+  InitOnceExecuteOnce(&once, char_info_table_init_callback_, NULL, NULL);
+}
+#else
+static void char_info_table_init_once_(void) {
+  static pthread_once_t once = PTHREAD_ONCE_INIT;
+  pthread_once(&once, char_info_table_init_);
+}
+#endif  // TCOD_NO_THREADS
+/**
+    Make sure `char_info_table` is filled and visible to this thread.  The table is filled once on the first print.
+ */
+static void char_info_table_ensure_(void) {
+  static TCOD_THREAD_LOCAL_ bool ready = false;  // Avoids the synchronized check after the first call on a thread.
+  if (ready) return;
+  char_info_table_init_once_();
+  ready = true;
+}
+/**
+    Return the CharInfo flags of a codepoint.
+ */
+TCOD_NODISCARD
+static uint8_t get_char_info(int codepoint) {
+  if (codepoint < 0 || codepoint >= 0x10000) {
+    return compute_char_info_(codepoint);
+  }
+  char_info_table_ensure_();
+  const int block = char_info_table.block_index[codepoint >> CHAR_INFO_BLOCK_BITS];
+  if (block == CHAR_INFO_NO_BLOCK) {
+    return compute_char_info_(codepoint);
+  }
+  return char_info_table.blocks[block][codepoint & (CHAR_INFO_BLOCK_SIZE - 1)];
 }
 /**
     A variable that toggles double wide character handing in print functions.
@@ -917,16 +1021,8 @@ static const bool TCOD_double_width_print_mode = 0;
  */
 TCOD_NODISCARD
 static int get_character_width(int codepoint) {
-  const utf8proc_property_t* property = utf8proc_get_property(codepoint);
-  if (property->category == UTF8PROC_CATEGORY_CO) {  // Private Use Area.
-    return 1;  // Width would otherwise be zero.
-  }
-  switch (property->charwidth) {
-    default:
-      return (int)property->charwidth;
-    case 2:
-      return TCOD_double_width_print_mode ? 2 : 1;
-  }
+  const int width = get_char_info(codepoint) & CHAR_INFO_WIDTH_MASK;
+  return width == 2 && !TCOD_double_width_print_mode ? 1 : width;
 }
 /**
     Get the next line-break or null terminator, or break the string before
@@ -961,9 +1057,9 @@ static TCOD_Error next_split_(
     if ((err = fp_peek(&it, &codepoint)) < 0) {
       return err;
     }
-    const utf8proc_property_t* property = utf8proc_get_property(codepoint);
+    const uint8_t info = get_char_info(codepoint);
     if (can_split && char_width > 0) {
-      switch (property->category) {
+      switch (info & (CHAR_INFO_DASH | CHAR_INFO_SPACE)) {
         default:
           if (char_width + get_character_width(codepoint) > max_width) {
             // The next character would go over the max width, so return now.
@@ -981,7 +1077,7 @@ static TCOD_Error next_split_(
           }
           separating = false;
           break;
-        case UTF8PROC_CATEGORY_PD:  // Punctuation, dash
+        case CHAR_INFO_DASH:  // Punctuation, dash
           if (char_width + get_character_width(codepoint) > max_width) {
             *break_point = it.string;
             *break_width = char_width;
@@ -998,7 +1094,7 @@ static TCOD_Error next_split_(
             continue;
           }
           break;
-        case UTF8PROC_CATEGORY_ZS:  // Separator, space
+        case CHAR_INFO_SPACE:  // Separator, space
           if (!separating) {
             *break_point = it.string;
             *break_width = char_width;
@@ -1007,7 +1103,7 @@ static TCOD_Error next_split_(
           break;
       }
     }
-    if (is_newline(codepoint)) {
+    if (info & CHAR_INFO_NEWLINE) {
       // Always break on newlines.
       *break_point = it.string;
       *break_width = char_width;
@@ -1038,7 +1134,106 @@ typedef struct PrintParams {
   TCOD_alignment_t alignment;
   bool can_split;  // In general `can_split = false` is deprecated.
   bool count_only;  // True if console is read-only.
+  struct TCOD_TextLayout* __restrict layout;  // If not NULL then glyphs are recorded here instead of printed.
 } PrintParams;
+/**
+    A glyph of a text layout, positioned relative to the top-left of the layout.
+ */
+struct TCOD_TextLayoutGlyph {
+  int ch;
+  int x;
+  int y;
+  TCOD_ColorRGBA fg;  // Alpha is zero if the foreground is unchanged.
+  TCOD_ColorRGBA bg;  // Alpha is zero if the background is unchanged.
+};
+struct TCOD_TextLayout {
+  int height;  // Height of the text, the same as the get_height functions.
+  int glyph_count;
+  int glyph_capacity;
+  struct TCOD_TextLayoutGlyph* glyphs;
+};
+/**
+    Append a glyph to a text layout.
+ */
+TCOD_NODISCARD
+static TCOD_Error text_layout_push_(
+    struct TCOD_TextLayout* __restrict layout, int ch, int x, int y, TCOD_ColorRGBA fg, TCOD_ColorRGBA bg) {
+  if (layout->glyph_count == layout->glyph_capacity) {
+    const int new_capacity = layout->glyph_capacity ? layout->glyph_capacity * 2 : 16;
+    struct TCOD_TextLayoutGlyph* new_glyphs = realloc(layout->glyphs, sizeof(*new_glyphs) * new_capacity);
+    if (!new_glyphs) {
+      TCOD_set_errorv("Out of memory.");
+      return TCOD_E_OUT_OF_MEMORY;
+    }
+    layout->glyphs = new_glyphs;
+    layout->glyph_capacity = new_capacity;
+  }
+  layout->glyphs[layout->glyph_count++] = (struct TCOD_TextLayoutGlyph){ch, x, y, fg, bg};
+  return TCOD_E_OK;
+}
+/**
+    Return the number of printable ASCII characters at the start of `string`, stopping at `end`.
+
+    Printable ASCII has no color codes, line breaks, or multi-byte sequences and is always one tile wide.
+    Characters are checked 16 at a time.
+ */
+TCOD_NODISCARD
+static int ascii_run_length_(const unsigned char* __restrict string, const unsigned char* __restrict end) {
+  static const uint64_t ones = 0x0101010101010101ULL;
+  static const uint64_t high_bits = 0x8080808080808080ULL;
+  const unsigned char* it = string;
+  while (end - it >= 16) {
+    uint64_t words[2];
+    memcpy(words, it, sizeof(words));
+    uint64_t outside = 0;  // High bits are set for any byte below 0x20 or above 0x7E, with possible false positives.
+    for (int i = 0; i < 2; ++i) {
+      outside |= ((words[i] - ones * 0x20) & ~words[i]) | ((words[i] + ones) | words[i]);
+    }
+    if (outside & high_bits) {
+      break;  // The exact position is found below.
+    }
+    it += sizeof(words);
+  }
+  while (it < end && 0x20 <= *it && *it <= 0x7E) {
+    ++it;
+  }
+  return (int)(it - string);
+}
+/**
+    Print a run of printable ASCII characters directly to the console tiles.
+
+    This has the same effect as printing each character with `TCOD_console_put_rgb`.
+ */
+static void print_ascii_run_(
+    const PrintParams* __restrict params,
+    const FormattedPrinter* __restrict printer,
+    int x,
+    int y,
+    int clip_left,
+    int clip_right,
+    int length) {
+  TCOD_Console* console = params->console;
+  const int begin = MAX(MAX(x, clip_left), 0);
+  const int end = MIN(MIN(x + length, clip_right), console->w);
+  if (y < 0 || y >= console->h || begin >= end) {
+    return;
+  }
+  TCOD_ConsoleTile* __restrict row = &console->tiles[y * console->w];
+  const unsigned char* __restrict chars = printer->string;
+  for (int i = begin; i < end; ++i) {
+    row[i].ch = chars[i - x];
+  }
+  if (printer->fg.a) {
+    const TCOD_ColorRGBA fg = {printer->fg.r, printer->fg.g, printer->fg.b, 255};
+    for (int i = begin; i < end; ++i) {
+      row[i].fg = fg;
+    }
+  }
+  TCOD_console_mark_dirty(console, begin, y, end - begin, 1);
+  if (printer->bg.a) {
+    TCOD_console_blend_rect(console, begin, y, end - begin, 1, (const TCOD_ColorRGB*)&printer->bg, 0, params->flag);
+  }
+}
 TCOD_NODISCARD
 static int printn_internal_(const PrintParams* __restrict params, size_t n, const char* __restrict string) {
   if (!params->console) {
@@ -1097,10 +1292,10 @@ static int printn_internal_(const PrintParams* __restrict params, size_t n, cons
     if (err < 0) {
       return err;
     }
-    const utf8proc_property_t* property = utf8proc_get_property(codepoint);
+    const uint8_t info = get_char_info(codepoint);
     // Check for newlines.
-    if (is_newline(codepoint)) {
-      if (property->category == UTF8PROC_CATEGORY_ZP) {
+    if (info & CHAR_INFO_NEWLINE) {
+      if (info & CHAR_INFO_PARAGRAPH) {
         top += 2;
       } else {
         top += 1;
@@ -1144,6 +1339,15 @@ static int printn_internal_(const PrintParams* __restrict params, size_t n, cons
       clip_right = params->console->w;
     }
     while (printer.string < line_break) {
+      if (!params->count_only && !params->layout) {
+        const int run = ascii_run_length_(printer.string, line_break);
+        if (run > 0) {
+          print_ascii_run_(params, &printer, cursor_x, top, clip_left, clip_right, run);
+          printer.string += run;
+          cursor_x += run;
+          continue;
+        }
+      }
       // Iterate over a line of characters.
       if ((err = fp_next(&printer, &codepoint)) < 0) {  // Advances printer.string.
         return err;
@@ -1154,7 +1358,12 @@ static int printn_internal_(const PrintParams* __restrict params, size_t n, cons
       if (get_character_width(codepoint) == 0) {
         continue;
       }
-      if (clip_left <= cursor_x && cursor_x < clip_right) {
+      if (params->layout && clip_left <= cursor_x && cursor_x < clip_right) {
+        err = text_layout_push_(params->layout, codepoint, cursor_x - params->x, top - y, printer.fg, printer.bg);
+        if (err < 0) {
+          return err;
+        }
+      } else if (clip_left <= cursor_x && cursor_x < clip_right) {
         // Actually render this line of characters.
         TCOD_ColorRGB* fg_rgb = printer.fg.a ? (TCOD_ColorRGB*)&printer.fg : NULL;
         TCOD_ColorRGB* bg_rgb = printer.bg.a ? (TCOD_ColorRGB*)&printer.bg : NULL;
@@ -1168,7 +1377,7 @@ static int printn_internal_(const PrintParams* __restrict params, size_t n, cons
       if ((err = fp_peek(&printer, &codepoint)) < 0) {
         return err;
       }
-      if (utf8proc_get_property(codepoint)->category != UTF8PROC_CATEGORY_ZS) {
+      if (!(get_char_info(codepoint) & CHAR_INFO_SPACE)) {
         break;
       }
       if ((err = fp_next(&printer, NULL)) < 0) {
@@ -1182,31 +1391,74 @@ static int printn_internal_(const PrintParams* __restrict params, size_t n, cons
   }
   return MIN(top, bottom) - y + 1;
 }
+#define SCRATCH_BUFFER_SIZE 4096
+/**
+    Format a string into `stack_buffer`, or into a reusable thread-local buffer if it does not fit.
+
+    `*out` is set to the formatted string, which is valid until the next call on the same thread.
+    Returns the length of the string, or a negative error code.
+
+    The thread-local buffer is SCRATCH_BUFFER_SIZE bytes of static storage, so printing in a loop does not allocate.
+    Longer strings are formatted into a new allocation which is returned in `*owned` and must be freed by the caller,
+    `*owned` is NULL otherwise.
+ */
 TCOD_NODISCARD
-static int vprintf_internal_(const PrintParams* __restrict params, const char* __restrict fmt, va_list args) {
-  char stack_buffer[512];  // This buffer attempts to prevent a heap allocation.
-  char* heap_buffer = NULL;  // Heap buffer to hold the result in case of overflow.
-  char* active_buffer = stack_buffer;  // Which buffer will be passed down.
+static int vformat_scratch_(
+    char* __restrict stack_buffer,
+    size_t stack_size,
+    const char** __restrict out,
+    char** __restrict owned,
+    const char* __restrict fmt,
+    va_list args) {
+  static TCOD_THREAD_LOCAL_ char scratch_buffer[SCRATCH_BUFFER_SIZE];  // Released with the thread.
   va_list args_copy;
   va_copy(args_copy, args);
-  int str_length = vsnprintf(stack_buffer, sizeof(stack_buffer), fmt, args_copy);
+  int str_length = vsnprintf(stack_buffer, stack_size, fmt, args_copy);
   va_end(args_copy);
-  if (str_length >= (int)sizeof(stack_buffer)) {
-    active_buffer = heap_buffer = malloc(str_length + 1);
-    if (!heap_buffer) {
+  *out = stack_buffer;
+  *owned = NULL;
+  if (str_length < 0) {
+    TCOD_set_errorvf("vsnprintf error: %i", str_length);
+    return TCOD_E_ERROR;
+  }
+  if ((size_t)str_length < stack_size) {
+    return str_length;
+  }
+  char* buffer;
+  size_t buffer_size;
+  if (str_length < SCRATCH_BUFFER_SIZE) {
+    buffer = scratch_buffer;
+    buffer_size = SCRATCH_BUFFER_SIZE;
+  } else {
+    buffer_size = (size_t)str_length + 1;
+    buffer = *owned = malloc(buffer_size);
+    if (!buffer) {
       TCOD_set_errorv("Out of memory.");
       return TCOD_E_OUT_OF_MEMORY;
     }
-    str_length = vsnprintf(heap_buffer, str_length + 1, fmt, args);
   }
+  str_length = vsnprintf(buffer, buffer_size, fmt, args);
   if (str_length < 0) {
+    free(*owned);
+    *owned = NULL;
     TCOD_set_errorvf("vsnprintf error: %i", str_length);
-    free(heap_buffer);
     return TCOD_E_ERROR;
   }
-  int err = printn_internal_(params, str_length, active_buffer);
-  free(heap_buffer);
-  return err;
+  *out = buffer;
+  return str_length;
+}
+TCOD_NODISCARD
+static int vprintf_internal_(const PrintParams* __restrict params, const char* __restrict fmt, va_list args) {
+  char stack_buffer[512];  // Most strings fit here.
+  const char* str = NULL;
+  char* owned = NULL;
+  const int str_length = vformat_scratch_(stack_buffer, sizeof(stack_buffer), &str, &owned, fmt, args);
+  if (str_length < 0) {
+    return str_length;
+  }
+  const int result = printn_internal_(params, str_length, str);
+  free(owned);
+  return result;
 }
 /**
  *  Normalize rectangle values using old libtcod rules where alignment can move
@@ -1311,6 +1563,74 @@ int TCOD_console_get_height_rect_wn(int width, size_t n, const char* __restrict
   TCOD_Console console = {.w = width, .h = INT_MAX};  // get_height functions don't need a fully defined console.
   return TCOD_console_get_height_rect_n(&console, 0, 0, width, INT_MAX, n, str);
 }
+TCOD_TextLayout* TCOD_text_layout_new(
+    int width,
+    size_t n,
+    const char* __restrict str,
+    const TCOD_ColorRGB* __restrict fg,
+    const TCOD_ColorRGB* __restrict bg,
+    TCOD_alignment_t alignment) {
+  if (width <= 0) {
+    TCOD_set_errorvf("Width must be greater than zero, got %i.", width);
+    return NULL;
+  }
+  TCOD_TextLayout* layout = calloc(1, sizeof(*layout));
+  if (!layout) {
+    TCOD_set_errorv("Out of memory.");
+    return NULL;
+  }
+  TCOD_Console console = {.w = width, .h = INT_MAX};  // Layouts don't need a fully defined console.
+  const PrintParams params = {
+      .console = &console,
+      .width = width,
+      .height = INT_MAX,
+      .rgb_fg = fg,
+      .rgb_bg = bg,
+      .flag = TCOD_BKGND_NONE,
+      .alignment = alignment,
+      .can_split = true,
+      .count_only = false,
+      .layout = layout,
+  };
+  const int height = printn_internal_(&params, n, str);
+  if (height < 0) {
+    TCOD_text_layout_delete(layout);
+    return NULL;
+  }
+  layout->height = height;
+  return layout;
+}
+void TCOD_text_layout_delete(TCOD_TextLayout* layout) {
+  if (!layout) {
+    return;
+  }
+  free(layout->glyphs);
+  free(layout);
+}
+int TCOD_text_layout_get_height(const TCOD_TextLayout* layout) { return layout ? layout->height : 0; }
+TCOD_Error TCOD_text_layout_draw(
+    const TCOD_TextLayout* __restrict layout,
+    TCOD_Console* __restrict console,
+    int x,
+    int y,
+    int height,
+    TCOD_bkgnd_flag_t flag) {
+  console = TCOD_console_validate_(console);
+  if (!layout || !console) {
+    TCOD_set_errorv("Layout and console must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  for (int i = 0; i < layout->glyph_count; ++i) {
+    const struct TCOD_TextLayoutGlyph* glyph = &layout->glyphs[i];
+    if (height > 0 && glyph->y >= height) {
+      break;  // Glyphs are stored in order, so the rest are below the region.
+    }
+    const TCOD_ColorRGB* fg_rgb = glyph->fg.a ? (const TCOD_ColorRGB*)&glyph->fg : NULL;
+    const TCOD_ColorRGB* bg_rgb = glyph->bg.a ? (const TCOD_ColorRGB*)&glyph->bg : NULL;
+    TCOD_console_put_rgb(console, x + glyph->x, y + glyph->y, glyph->ch, fg_rgb, bg_rgb, flag);
+  }
+  return TCOD_E_OK;
+}
 TCOD_Error TCOD_console_printn_frame(
     struct TCOD_Console* __restrict con,
     int x,
@@ -1503,20 +1823,22 @@ TCOD_Error TCOD_console_printf_frame(
     TCOD_set_errorv("Console pointer must not be NULL.");
     return TCOD_E_INVALID_ARGUMENT;
   }
-  char* str = NULL;
+  char stack_buffer[512];
+  const char* str = NULL;
+  char* owned = NULL;
   int len = 0;
   if (fmt) {
     va_list ap;
     va_start(ap, fmt);
-    len = vsprint_(&str, fmt, ap);
+    len = vformat_scratch_(stack_buffer, sizeof(stack_buffer), &str, &owned, fmt, ap);
     va_end(ap);
     if (len < 0) {
-      TCOD_set_errorv("Error while resolving formatting string.");
-      return TCOD_E_ERROR;
+      return (TCOD_Error)len;
     }
   }
-  TCOD_Error err = TCOD_console_printn_frame(con, x, y, width, height, len, str, &con->fore, &con->back, flag, empty);
-  free(str);
+  const TCOD_Error err =
+      TCOD_console_printn_frame(con, x, y, width, height, len, str, &con->fore, &con->back, flag, empty);
+  free(owned);
   return err;
 }
 int TCOD_printf_rgb(TCOD_Console* __restrict console, TCOD_PrintParamsRGB params, const char* __restrict fmt, ...) {
@@ -415,6 +415,80 @@ TCOD_PUBLIC int TCOD_console_get_height_rect_n(
     \endrst
  */
 TCOD_PUBLIC int TCOD_console_get_height_rect_wn(int width, size_t n, const char* __restrict str);
+/**
+    @brief A string which has been word-wrapped and had its color codes parsed ahead of time.
+
+    Text which is printed every frame, such as a message log or tooltips, can be laid out once with
+    `TCOD_text_layout_new` and then drawn any number of times without decoding the string again.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+typedef struct TCOD_TextLayout TCOD_TextLayout;
+/**
+    @brief Lay out a string for a region of the given width.
+
+    @param width The maximum width of the text in tiles, must be greater than zero.
+    @param n The length of the string buffer `str[n]` in bytes.
+    @param str The text to lay out.  This string can contain libtcod color codes.
+    @param fg The foreground color of the text.  If NULL then the foreground will be left unchanged when drawn.
+    @param bg The background color of the text.  If NULL then the background will be left unchanged when drawn.
+    @param alignment The text justification.
+    @return A new layout, or NULL on error.
+
+    The results are the same as `TCOD_console_printn_rect` with the same parameters.
+    Color control codes set by `TCOD_console_set_color_control` are read once here.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_NODISCARD TCOD_TextLayout* TCOD_text_layout_new(
+    int width,
+    size_t n,
+    const char* __restrict str,
+    const TCOD_ColorRGB* __restrict fg,
+    const TCOD_ColorRGB* __restrict bg,
+    TCOD_alignment_t alignment);
+/**
+    @brief Delete a text layout.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC void TCOD_text_layout_delete(TCOD_TextLayout* layout);
+/**
+    @brief Return the height of a text layout, the same as `TCOD_console_get_height_rect_wn`.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC int TCOD_text_layout_get_height(const TCOD_TextLayout* layout);
+/**
+    @brief Draw a text layout onto a console.
+
+    @param layout The text layout to draw.
+    @param console A pointer to a TCOD_Console.
+    @param x The left-most position of the layout region.
+    @param y The top-most position of the layout region.
+    @param height The maximum number of rows to draw, or zero to draw every row.
+    @param flag The background blending flag.
+    @return A negative error code on failure.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_text_layout_draw(
+    const TCOD_TextLayout* __restrict layout,
+    TCOD_Console* __restrict console,
+    int x,
+    int y,
+    int height,
+    TCOD_bkgnd_flag_t flag);
 // Deprecated function.
 TCOD_PUBLIC TCOD_Error TCOD_console_printn_frame(
     TCOD_Console* __restrict console,
@@ -188,8 +188,10 @@ inline int get_height_rect(int width, std::string_view str) {
  */
 template <typename... T>
 inline std::string stringf(const char* format, T... args) {
-  const int str_length = snprintf(nullptr, 0, format, args...);
+  char stack_buffer[256];  // Most strings are formatted in a single pass using this buffer.
+  const int str_length = snprintf(stack_buffer, sizeof(stack_buffer), format, args...);
   if (str_length < 0) throw std::runtime_error("Failed to format string.");
+  if (str_length < static_cast<int>(sizeof(stack_buffer))) return std::string(stack_buffer, str_length);
   std::string out(str_length, '\0');
   snprintf(&out[0], str_length + 1, format, args...);
   return out;
@@ -0,0 +1,294 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice and the libtcod contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "console_stack.h"
+
+#include <stdlib.h>
+
+#include "libtcod_int.h"
+#include "utility.h"
+
+/**
+    A console owned by a stack and the parameters used to blend it.
+ */
+struct TCOD_ConsoleLayer {
+  TCOD_Console* console;  // Owning pointer to this layers console, with write tracking enabled.
+  int x;  // Offset of the layer on the composited console.
+  int y;
+  float fg_alpha;
+  float bg_alpha;
+  bool has_key_color;
+  TCOD_ColorRGB key_color;
+  bool visible;
+};
+struct TCOD_ConsoleStack {
+  int width;  // Size of the composited console.
+  int height;
+  int layer_count;
+  int layer_capacity;
+  struct TCOD_ConsoleLayer* layers;  // Layers from bottom to top, `layer_count` elements.
+  TCOD_ConsoleDirtySpan* dirty_rows;  // Regions of the composited console which need to be redrawn, `height` elements.
+  const TCOD_Console* last_console;  // The console composited into by the previous call, or NULL.
+};
+/**
+    Mark a region of the composited console as needing to be redrawn.
+ */
+static void stack_mark_dirty_(TCOD_ConsoleStack* __restrict stack, int x, int y, int width, int height) {
+  const int left = MAX(x, 0);
+  const int right = MIN(x + width, stack->width);
+  if (left >= right) {
+    return;
+  }
+  for (int row = MAX(y, 0); row < MIN(y + height, stack->height); ++row) {
+    TCOD_ConsoleDirtySpan* span = &stack->dirty_rows[row];
+    span->begin = MIN(span->begin, left);
+    span->end = MAX(span->end, right);
+  }
+}
+/**
+    Mark the region covered by a layer as needing to be redrawn, if the layer is visible.
+ */
+static void stack_mark_layer_(TCOD_ConsoleStack* __restrict stack, const struct TCOD_ConsoleLayer* __restrict layer) {
+  if (!layer->visible) {
+    return;
+  }
+  stack_mark_dirty_(stack, layer->x, layer->y, layer->console->w, layer->console->h);
+}
+/**
+    Return a layer from a stack, or set an error and return NULL.
+ */
+static struct TCOD_ConsoleLayer* stack_get_layer_(TCOD_ConsoleStack* stack, int layer) {
+  if (!stack) {
+    TCOD_set_errorv("Console stack must not be NULL.");
+    return NULL;
+  }
+  if (layer < 0 || layer >= stack->layer_count) {
+    TCOD_set_errorvf("Layer index %i is out of range, the stack has %i layers.", layer, stack->layer_count);
+    return NULL;
+  }
+  return &stack->layers[layer];
+}
+TCOD_ConsoleStack* TCOD_console_stack_new(int width, int height) {
+  if (width <= 0 || height <= 0) {
+    TCOD_set_errorvf("Width and height must be greater than zero: got %i,%i", width, height);
+    return NULL;
+  }
+  TCOD_ConsoleStack* stack = calloc(1, sizeof(*stack));
+  if (!stack) {
+    TCOD_set_errorv("Out of memory.");
+    return NULL;
+  }
+  stack->width = width;
+  stack->height = height;
+  stack->dirty_rows = malloc(sizeof(*stack->dirty_rows) * height);
+  if (!stack->dirty_rows) {
+    TCOD_set_errorv("Out of memory.");
+    TCOD_console_stack_delete(stack);
+    return NULL;
+  }
+  for (int y = 0; y < height; ++y) {
+    stack->dirty_rows[y] = (TCOD_ConsoleDirtySpan){0, width};
+  }
+  return stack;
+}
+void TCOD_console_stack_delete(TCOD_ConsoleStack* stack) {
+  if (!stack) {
+    return;
+  }
+  for (int i = 0; i < stack->layer_count; ++i) {
+    TCOD_console_delete(stack->layers[i].console);
+  }
+  free(stack->layers);
+  free(stack->dirty_rows);
+  free(stack);
+}
+int TCOD_console_stack_add_layer(TCOD_ConsoleStack* stack, int width, int height) {
+  if (!stack) {
+    TCOD_set_errorv("Console stack must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (stack->layer_count == stack->layer_capacity) {
+    const int new_capacity = stack->layer_capacity ? stack->layer_capacity * 2 : 4;
+    struct TCOD_ConsoleLayer* new_layers = realloc(stack->layers, sizeof(*new_layers) * new_capacity);
+    if (!new_layers) {
+      TCOD_set_errorv("Out of memory.");
+      return TCOD_E_OUT_OF_MEMORY;
+    }
+    stack->layers = new_layers;
+    stack->layer_capacity = new_capacity;
+  }
+  TCOD_Console* console = TCOD_console_new(width, height);
+  if (!console) {
+    return TCOD_E_ERROR;
+  }
+  TCOD_Error err = TCOD_console_set_write_tracking(console, true);
+  if (err < 0) {
+    TCOD_console_delete(console);
+    return err;
+  }
+  stack->layers[stack->layer_count] = (struct TCOD_ConsoleLayer){
+      .console = console,
+      .fg_alpha = 1.0f,
+      .bg_alpha = 1.0f,
+      .visible = true,
+  };
+  stack_mark_layer_(stack, &stack->layers[stack->layer_count]);
+  return stack->layer_count++;
+}
+int TCOD_console_stack_get_layer_count(const TCOD_ConsoleStack* stack) { return stack ? stack->layer_count : 0; }
+TCOD_Console* TCOD_console_stack_get_layer(TCOD_ConsoleStack* stack, int layer) {
+  struct TCOD_ConsoleLayer* found = stack_get_layer_(stack, layer);
+  return found ? found->console : NULL;
+}
+TCOD_Error TCOD_console_stack_set_layer_offset(TCOD_ConsoleStack* stack, int layer, int x, int y) {
+  struct TCOD_ConsoleLayer* found = stack_get_layer_(stack, layer);
+  if (!found) {
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (found->x == x && found->y == y) {
+    return TCOD_E_OK;
+  }
+  stack_mark_layer_(stack, found);  // Uncover the old position.
+  found->x = x;
+  found->y = y;
+  stack_mark_layer_(stack, found);
+  return TCOD_E_OK;
+}
+TCOD_Error TCOD_console_stack_set_layer_alpha(
+    TCOD_ConsoleStack* stack, int layer, float foreground_alpha, float background_alpha) {
+  struct TCOD_ConsoleLayer* found = stack_get_layer_(stack, layer);
+  if (!found) {
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (found->fg_alpha == foreground_alpha && found->bg_alpha == background_alpha) {
+    return TCOD_E_OK;
+  }
+  found->fg_alpha = foreground_alpha;
+  found->bg_alpha = background_alpha;
+  stack_mark_layer_(stack, found);
+  return TCOD_E_OK;
+}
+TCOD_Error TCOD_console_stack_set_layer_key_color(
+    TCOD_ConsoleStack* stack, int layer, const TCOD_ColorRGB* key_color) {
+  struct TCOD_ConsoleLayer* found = stack_get_layer_(stack, layer);
+  if (!found) {
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  found->has_key_color = key_color != NULL;
+  if (key_color) {
+    found->key_color = *key_color;
+  }
+  stack_mark_layer_(stack, found);
+  return TCOD_E_OK;
+}
+TCOD_Error TCOD_console_stack_set_layer_visible(TCOD_ConsoleStack* stack, int layer, bool visible) {
+  struct TCOD_ConsoleLayer* found = stack_get_layer_(stack, layer);
+  if (!found) {
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (found->visible == visible) {
+    return TCOD_E_OK;
+  }
+  found->visible = true;
+  stack_mark_layer_(stack, found);  // Redraw the layers region whether it's being shown or hidden.
+  found->visible = visible;
+  return TCOD_E_OK;
+}
+TCOD_Error TCOD_console_stack_composite(TCOD_ConsoleStack* stack, TCOD_Console* console) {
+  if (!stack) {
+    TCOD_set_errorv("Console stack must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  console = TCOD_console_validate_(console);
+  if (!console) {
+    TCOD_set_errorv("Console must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (console->w != stack->width || console->h != stack->height) {
+    TCOD_set_errorvf(
+        "Console must be %ix%i to match the stack, but is %ix%i.", stack->width, stack->height, console->w, console->h);
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (console != stack->last_console) {
+    stack_mark_dirty_(stack, 0, 0, stack->width, stack->height);
+  }
+  // Collect the writes made to each layer since the last call.
+  for (int i = 0; i < stack->layer_count; ++i) {
+    struct TCOD_ConsoleLayer* layer = &stack->layers[i];
+    TCOD_Console* layer_console = layer->console;
+    if (!layer_console->dirty_rows) {
+      stack_mark_layer_(stack, layer);  // Write tracking was disabled, so any part of this layer may have changed.
+      continue;
+    }
+    for (int y = 0; y < layer_console->h; ++y) {
+      TCOD_ConsoleDirtySpan* span = &layer_console->dirty_rows[y];
+      if (layer->visible && span->begin < span->end) {
+        stack_mark_dirty_(stack, layer->x + span->begin, layer->y + y, span->end - span->begin, 1);
+      }
+      *span = (TCOD_ConsoleDirtySpan){layer_console->w, 0};
+    }
+  }
+  static const TCOD_ConsoleTile blank = {0x20, {255, 255, 255, 255}, {0, 0, 0, 255}};
+  for (int y = 0; y < stack->height; ++y) {
+    TCOD_ConsoleDirtySpan* span = &stack->dirty_rows[y];
+    const int begin = MAX(span->begin, 0);
+    const int end = MIN(span->end, stack->width);
+    *span = (TCOD_ConsoleDirtySpan){stack->width, 0};
+    if (begin >= end) {
+      continue;
+    }
+    TCOD_ConsoleTile* row = &console->tiles[y * console->w];
+    for (int x = begin; x < end; ++x) {
+      row[x] = blank;
+    }
+    TCOD_console_mark_dirty(console, begin, y, end - begin, 1);
+    for (int i = 0; i < stack->layer_count; ++i) {
+      const struct TCOD_ConsoleLayer* layer = &stack->layers[i];
+      if (!layer->visible || y < layer->y || y >= layer->y + layer->console->h) {
+        continue;
+      }
+      TCOD_console_blit_key_color(
+          layer->console,
+          begin - layer->x,
+          y - layer->y,
+          end - begin,
+          1,
+          console,
+          begin,
+          y,
+          layer->fg_alpha,
+          layer->bg_alpha,
+          layer->has_key_color ? &layer->key_color : NULL);
+    }
+  }
+  stack->last_console = console;
+  return TCOD_E_OK;
+}
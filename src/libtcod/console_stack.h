@@ -0,0 +1,151 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice and the libtcod contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LIBTCOD_CONSOLE_STACK_H_
+#define LIBTCOD_CONSOLE_STACK_H_
+#include <stdbool.h>
+
+#include "color.h"
+#include "config.h"
+#include "console.h"
+#include "error.h"
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+/**
+    An ordered stack of console layers which are composited into a single console.
+
+    Each layer is a console owned by the stack with its own offset, alpha,
+    key color, and visibility.  Writes to the layers are tracked, so
+    compositing only redraws the regions which changed since the last call.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+typedef struct TCOD_ConsoleStack TCOD_ConsoleStack;
+/**
+    Return a new console stack which composites into consoles of `width` by `height` tiles.
+
+    Returns NULL on error, see `TCOD_get_error`.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_NODISCARD TCOD_ConsoleStack* TCOD_console_stack_new(int width, int height);
+/**
+    Delete a console stack and all of its layer consoles.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC void TCOD_console_stack_delete(TCOD_ConsoleStack* stack);
+/**
+    Add a new layer of `width` by `height` tiles on top of the existing layers.
+
+    The new layer is visible, opaque, has no key color, and is placed at the
+    top-left corner.  Returns the index of the new layer, or a negative error
+    code on failure.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC int TCOD_console_stack_add_layer(TCOD_ConsoleStack* stack, int width, int height);
+/**
+    Return the number of layers in `stack`.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC int TCOD_console_stack_get_layer_count(const TCOD_ConsoleStack* stack);
+/**
+    Return the console of a layer so that it can be drawn on, or NULL if `layer` is out of range.
+
+    The console is owned by the stack.  It has write tracking enabled, which
+    must stay enabled for partial compositing to work.  Code which writes to
+    its tiles directly must call `TCOD_console_mark_dirty`.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Console* TCOD_console_stack_get_layer(TCOD_ConsoleStack* stack, int layer);
+/**
+    Move a layer so that its top-left corner is at `x`,`y` of the composited console.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_console_stack_set_layer_offset(TCOD_ConsoleStack* stack, int layer, int x, int y);
+/**
+    Set the foreground and background alpha used to blend a layer, the same as in `TCOD_console_blit`.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_console_stack_set_layer_alpha(
+    TCOD_ConsoleStack* stack, int layer, float foreground_alpha, float background_alpha);
+/**
+    Set the key color of a layer.  Tiles with this background color are transparent.
+
+    `key_color` can be NULL to disable the key color.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_console_stack_set_layer_key_color(
+    TCOD_ConsoleStack* stack, int layer, const TCOD_ColorRGB* key_color);
+/**
+    Show or hide a layer.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_console_stack_set_layer_visible(TCOD_ConsoleStack* stack, int layer, bool visible);
+/**
+    Composite the visible layers of `stack` into `console`, bottom layer first.
+
+    `console` must be the size given to `TCOD_console_stack_new`.  Tiles not
+    covered by any layer are cleared to a space with a white foreground and a
+    black background.
+
+    Only the regions where layers were written to, moved, or changed since the
+    last call are redrawn, these regions are marked dirty on `console` so that
+    renderers tracking its writes only redraw them as well.  Everything is
+    redrawn when a different console is passed from the previous call.
+    `console` should not be modified outside of this function.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_console_stack_composite(TCOD_ConsoleStack* stack, TCOD_Console* console);
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+#endif  // LIBTCOD_CONSOLE_STACK_H_
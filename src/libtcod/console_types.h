@@ -414,6 +414,17 @@ typedef enum TCOD_renderer_t {
       \endrst
    */
   TCOD_RENDERER_XTERM,
+  /**
+      An offscreen renderer which draws consoles to an in-memory RGBA buffer.
+
+      No window is created.  Frames are retrieved with
+      `TCOD_context_screen_capture` or `TCOD_renderer_headless_get_pixels`.
+
+      \rst
+      .. versionadded:: Unreleased
+      \endrst
+   */
+  TCOD_RENDERER_HEADLESS,
   TCOD_NB_RENDERERS,
 } TCOD_renderer_t;
 #endif  // TCOD_CONSOLE_TYPES_H_
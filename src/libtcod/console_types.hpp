@@ -125,6 +125,7 @@ class Console {
       *this = Console{{rhs.console_->w, rhs.console_->h}};
     }
     std::copy(rhs.console_->begin(), rhs.console_->end(), console_->begin());
+    TCOD_console_mark_dirty(console_.get(), 0, 0, console_->w, console_->h);
     return *this;
   }
   /***************************************************************************
@@ -220,7 +221,7 @@ class Console {
       @endcode
    */
   void clear(const TCOD_ConsoleTile& tile = {0x20, {255, 255, 255, 255}, {0, 0, 0, 255}}) noexcept {
-    for (auto& it : *this) it = tile;
+    console_->clear(tile);
   }
   /***************************************************************************
       @brief Return a reference to the tile at `xy`.
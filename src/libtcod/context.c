@@ -41,6 +41,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "libtcod_int.h"
+
 struct TCOD_Context* TCOD_context_new_(void) {
   struct TCOD_Context* renderer = calloc(sizeof(*renderer), 1);
   return renderer;
@@ -50,6 +52,7 @@ void TCOD_context_delete(struct TCOD_Context* renderer) {
   if (!renderer) {
     return;
   }
+  TCOD_context_set_async_present(renderer, false);
   if (renderer->c_destructor_) {
     renderer->c_destructor_(renderer);
   }
@@ -68,6 +71,11 @@ TCOD_Error TCOD_context_present(
   if (!context->c_present_) {
     return TCOD_set_errorv("Context is missing a present method.");
   }
+  if (context->c_request_tiles_) {
+    const TCOD_Error err = context->c_request_tiles_(context, console);  // The render thread must not do this.
+    if (err < 0) return err;
+  }
+  if (context->async_) return TCOD_context_async_present_(context, console, viewport);
   return context->c_present_(context, console, viewport);
 }
 TCOD_Error TCOD_context_screen_pixel_to_tile_d(struct TCOD_Context* context, double* x, double* y) {
@@ -78,7 +86,7 @@ TCOD_Error TCOD_context_screen_pixel_to_tile_d(struct TCOD_Context* context, dou
   if (!context->c_pixel_to_tile_) {
     return TCOD_E_OK;
   }
-  context->c_pixel_to_tile_(context, x, y);
+  TCOD_context_async_pixel_to_tile_(context, x, y);
   return TCOD_E_OK;
 }
 TCOD_Error TCOD_context_screen_pixel_to_tile_i(struct TCOD_Context* context, int* x, int* y) {
@@ -136,10 +144,12 @@ TCOD_PUBLIC TCOD_Error TCOD_context_save_screenshot(struct TCOD_Context* context
     }
     filename = unique_path;
   }
+  TCOD_context_async_sync_(context);
   if (!context->c_save_screenshot_) {
     int width = 0;
     int height = 0;
     TCOD_ColorRGBA* pixels = TCOD_context_screen_capture_alloc(context, &width, &height);
+    if (!pixels) return TCOD_E_ERROR;
     lodepng_encode32_file(filename, (const unsigned char*)pixels, (unsigned)width, (unsigned)height);
     free(pixels);
     return TCOD_E_OK;
@@ -167,6 +177,7 @@ TCOD_PUBLIC struct SDL_Renderer* TCOD_context_get_sdl_renderer(struct TCOD_Conte
   if (!context->c_get_sdl_renderer_) {
     return NULL;
   }
+  TCOD_context_async_sync_(context);
   return context->c_get_sdl_renderer_(context);
 }
 TCOD_Error TCOD_context_change_tileset(struct TCOD_Context* context, TCOD_Tileset* tileset) {
@@ -177,8 +188,20 @@ TCOD_Error TCOD_context_change_tileset(struct TCOD_Context* context, TCOD_Tilese
   if (!context->c_set_tileset_) {
     return TCOD_set_errorv("Context does not support changing tilesets.");
   }
+  TCOD_context_async_sync_(context);
   return context->c_set_tileset_(context, tileset);
 }
+TCOD_Error TCOD_context_set_tile_scaling(struct TCOD_Context* context, TCOD_ScaleFilter filter) {
+  if (!context) {
+    TCOD_set_errorv("Context must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (!context->c_set_tile_scaling_) {
+    return TCOD_set_errorv("Context does not support pre-scaled tiles.");
+  }
+  TCOD_context_async_sync_(context);
+  return context->c_set_tile_scaling_(context, filter);
+}
 int TCOD_context_get_renderer_type(struct TCOD_Context* context) {
   if (!context) {
     TCOD_set_errorv("Context must not be NULL.");
@@ -199,6 +222,7 @@ TCOD_Error TCOD_context_recommended_console_size(
   if (magnification <= 0) {
     magnification = 1.0f;
   }
+  TCOD_context_async_sync_(context);
   return context->c_recommended_console_size_(context, magnification, columns, rows);
 }
 TCOD_Error TCOD_context_screen_capture(
@@ -215,13 +239,14 @@ TCOD_Error TCOD_context_screen_capture(
     TCOD_set_errorv("width and height can not be NULL.");
     return TCOD_E_INVALID_ARGUMENT;
   }
+  TCOD_context_async_sync_(context);
   return context->c_screen_capture_(context, out_pixels, width, height);
 }
 
 TCOD_ColorRGBA* TCOD_context_screen_capture_alloc(
     struct TCOD_Context* __restrict context, int* __restrict width, int* __restrict height) {
   while (true) {
-    if (!TCOD_context_screen_capture(context, NULL, width, height)) return NULL;
+    if (TCOD_context_screen_capture(context, NULL, width, height) < 0) return NULL;
     TCOD_ColorRGBA* pixels = malloc((*width) * (*height) * sizeof(*pixels));
     if (!pixels) {
       TCOD_set_errorv("Failed to allocate image for screen capture.");
@@ -55,6 +55,7 @@ union SDL_Event;
 
 struct TCOD_Context;  // Defined in this header later.
 typedef struct TCOD_Context TCOD_Context;
+struct TCOD_ContextAsync_;  // Private, defined in context_async.c.
 
 /**
     A struct of parameters used to create a new context with `TCOD_context_new`.
@@ -312,6 +313,53 @@ TCOD_PUBLIC TCOD_Error TCOD_context_screen_capture(
 TCOD_NODISCARD
 TCOD_PUBLIC TCOD_ColorRGBA* TCOD_context_screen_capture_alloc(
     struct TCOD_Context* __restrict context, int* __restrict width, int* __restrict height);
+/***************************************************************************
+    @brief Enable or disable pipelined presentation for this context.
+
+    While enabled `TCOD_context_present` copies the console into a triple buffer and returns without waiting for the
+    frame to be rendered.  A render thread owned by the context does the rendering and any vsync wait, so game logic
+    can run while the previous frame is displayed.  If frames are presented faster than they can be rendered then
+    only the newest pending frame is kept.
+
+    Errors from a pipelined frame are returned by the next call to `TCOD_context_present`.
+
+    Other context functions first wait for any pending frames to finish, except for the pixel-to-tile conversions
+    which do not block.  The context must not be used by more than one of your threads.
+
+    The backend is called from the render thread while this is enabled.  SDL windows and renderers may only be used
+    from the thread which created them, so this is not supported by the SDL renderers and returns an error for them.
+
+    Tiles of lazily loaded tilesets are loaded by `TCOD_context_present` before the frame is queued, so the render
+    thread only reads the tileset.  Don't modify the contexts tileset directly while this is enabled.
+
+    @param context A non-NULL TCOD_Context object.
+    @param enable If true then start the render thread.  If false then finish pending frames and stop the thread.
+    @return Returns TCOD_E_ERROR if libtcod was built without thread support or if the context uses SDL.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_context_set_async_present(struct TCOD_Context* context, bool enable);
+/***************************************************************************
+    @brief Render consoles directly at their displayed size using pre-scaled tiles.
+
+    When a viewport enlarges the console by a whole number of times, such as with `integer_scaling`, the tiles are
+    resampled once with `filter` and the console is drawn straight to the window.  This skips the intermediate console
+    texture and the scaled copy of it made every frame, which is expensive at high resolutions on integrated GPUs and
+    software renderers.  Other viewports are rendered normally.
+
+    Since the whole console is drawn every frame while this is active, it is only used for scales of 2 or more.
+
+    @param context A non-NULL TCOD_Context object.
+    @param filter The filter used to resample tiles, or `TCOD_SCALE_FILTER_NONE` to disable pre-scaled tiles.
+    @return Returns an error if this context does not support pre-scaled tiles.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_context_set_tile_scaling(struct TCOD_Context* context, TCOD_ScaleFilter filter);
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -574,6 +622,20 @@ struct TCOD_Context {
       TCOD_ColorRGBA* __restrict out_pixels,
       int* __restrict width,
       int* __restrict height);
+  /**
+      Pipelined presentation state, NULL unless enabled with `TCOD_context_set_async_present`.
+   */
+  struct TCOD_ContextAsync_* async_;
+  /**
+      Change the filter used to pre-scale tiles, see `TCOD_context_set_tile_scaling`.
+   */
+  TCOD_Error (*c_set_tile_scaling_)(struct TCOD_Context* __restrict self, TCOD_ScaleFilter filter);
+  /**
+      Load the tiles used by `console` from a lazily loaded tileset before it is drawn.
+
+      This is always called from the thread presenting the console, never from a render thread.
+   */
+  TCOD_Error (*c_request_tiles_)(struct TCOD_Context* __restrict self, const struct TCOD_Console* __restrict console);
 };
 #ifdef __cplusplus
 namespace tcod {
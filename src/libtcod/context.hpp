@@ -275,6 +275,28 @@ class Context {
   auto change_tileset(tcod::Tileset& new_tileset) -> void {
     check_throw_error(TCOD_context_change_tileset(context_.get(), new_tileset.get()));
   }
+  /***************************************************************************
+      @brief Enable or disable pipelined presentation on a render thread.
+
+      See TCOD_context_set_async_present for the details and limitations.
+      \rst
+      .. versionadded:: Unreleased
+      \endrst
+   */
+  auto set_async_present(bool enable) -> void {
+    check_throw_error(TCOD_context_set_async_present(context_.get(), enable));
+  }
+  /***************************************************************************
+      @brief Render directly at integer zoom levels with tiles pre-scaled by `filter`.
+
+      See TCOD_context_set_tile_scaling for the details.
+      \rst
+      .. versionadded:: Unreleased
+      \endrst
+   */
+  auto set_tile_scaling(TCOD_ScaleFilter filter) -> void {
+    check_throw_error(TCOD_context_set_tile_scaling(context_.get(), filter));
+  }
   /***************************************************************************
       @brief Access the context pointer.  Modifying this pointer may make the class invalid.
    */
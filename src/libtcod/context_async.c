@@ -0,0 +1,265 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice and the libtcod contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "context.h"
+
+#include <stdlib.h>
+#include <string.h>
+#ifndef TCOD_NO_THREADS
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#endif  // TCOD_NO_THREADS
+
+#include "console.h"
+#include "error.h"
+#include "libtcod_int.h"
+
+#ifndef TCOD_NO_THREADS
+// Minimal portable threading primitives, only what the render thread needs.
+#if defined(_WIN32)
+typedef SRWLOCK AsyncMutex;
+typedef CONDITION_VARIABLE AsyncCond;
+typedef HANDLE AsyncThread;
+static void async_mutex_init(AsyncMutex* mutex) { InitializeSRWLock(mutex); }
+static void async_mutex_destroy(AsyncMutex* mutex) { (void)mutex; }
+static void async_mutex_lock(AsyncMutex* mutex) { AcquireSRWLockExclusive(mutex); }
+static void async_mutex_unlock(AsyncMutex* mutex) { ReleaseSRWLockExclusive(mutex); }
+static void async_cond_init(AsyncCond* cond) { InitializeConditionVariable(cond); }
+static void async_cond_destroy(AsyncCond* cond) { (void)cond; }
+static void async_cond_wait(AsyncCond* cond, AsyncMutex* mutex) { SleepConditionVariableSRW(cond, mutex, INFINITE, 0); }
+static void async_cond_broadcast(AsyncCond* cond) { WakeAllConditionVariable(cond); }
+#else
+typedef pthread_mutex_t AsyncMutex;
+typedef pthread_cond_t AsyncCond;
+typedef pthread_t AsyncThread;
+static void async_mutex_init(AsyncMutex* mutex) { pthread_mutex_init(mutex, NULL); }
+static void async_mutex_destroy(AsyncMutex* mutex) { pthread_mutex_destroy(mutex); }
+static void async_mutex_lock(AsyncMutex* mutex) { pthread_mutex_lock(mutex); }
+static void async_mutex_unlock(AsyncMutex* mutex) { pthread_mutex_unlock(mutex); }
+static void async_cond_init(AsyncCond* cond) { pthread_cond_init(cond, NULL); }
+static void async_cond_destroy(AsyncCond* cond) { pthread_cond_destroy(cond); }
+static void async_cond_wait(AsyncCond* cond, AsyncMutex* mutex) { pthread_cond_wait(cond, mutex); }
+static void async_cond_broadcast(AsyncCond* cond) { pthread_cond_broadcast(cond); }
+#endif
+
+#define TCOD_ASYNC_SLOTS 3
+/**
+    A snapshot of the arguments given to `TCOD_context_present`.
+ */
+struct AsyncFrame {
+  TCOD_Console* console;  // Owned copy of the presented console.
+  TCOD_ViewportOptions viewport;
+  bool has_viewport;
+};
+/**
+    Pipelined presentation state of a context.
+
+    The three frames form a triple buffer: one can be rendering, one can be pending, and the remaining one is always
+    free to be written to by `TCOD_context_present`, which never has to wait.
+ */
+struct TCOD_ContextAsync_ {
+  AsyncMutex lock;
+  AsyncCond frame_ready;  // Signaled when a frame becomes pending or when the render thread should exit.
+  AsyncCond frame_done;  // Signaled when the render thread finishes a frame.
+  AsyncThread thread;
+  struct AsyncFrame frames[TCOD_ASYNC_SLOTS];
+  int pending;  // Index of the newest unrendered frame, or -1.
+  int rendering;  // Index of the frame being rendered, or -1.
+  bool quit;
+  TCOD_Error error;  // The first error from a rendered frame, reported by the next present.
+  char error_msg[256];
+};
+/// Render frames until told to quit.  Pending frames are rendered before quitting.
+static void async_render_loop(struct TCOD_Context* context) {
+  struct TCOD_ContextAsync_* async = context->async_;
+  async_mutex_lock(&async->lock);
+  while (true) {
+    while (async->pending < 0 && !async->quit) async_cond_wait(&async->frame_ready, &async->lock);
+    if (async->pending < 0) break;
+    async->rendering = async->pending;
+    async->pending = -1;
+    const struct AsyncFrame* frame = &async->frames[async->rendering];
+    async_mutex_unlock(&async->lock);
+    const TCOD_Error err =
+        context->c_present_(context, frame->console, frame->has_viewport ? &frame->viewport : NULL);
+    async_mutex_lock(&async->lock);
+    if (err < 0 && async->error >= 0) {
+      async->error = err;
+      strncpy(async->error_msg, TCOD_get_error(), sizeof(async->error_msg) - 1);  // Errors are thread-local.
+    }
+    async->rendering = -1;
+    async_cond_broadcast(&async->frame_done);
+  }
+  async_mutex_unlock(&async->lock);
+}
+#if defined(_WIN32)
+static DWORD WINAPI async_thread_main(LPVOID context) {
+  async_render_loop(context);
+  return 0;
+}
+#else
+static void* async_thread_main(void* context) {
+  async_render_loop(context);
+  return NULL;
+}
+#endif
+/// Stop the render thread after it finishes any pending frames, then free the pipeline.
+static void async_stop(struct TCOD_Context* context) {
+  struct TCOD_ContextAsync_* async = context->async_;
+  async_mutex_lock(&async->lock);
+  async->quit = true;
+  async_cond_broadcast(&async->frame_ready);
+  async_mutex_unlock(&async->lock);
+#if defined(_WIN32)
+  WaitForSingleObject(async->thread, INFINITE);
+  CloseHandle(async->thread);
+#else
+  pthread_join(async->thread, NULL);
+#endif
+  async_cond_destroy(&async->frame_done);
+  async_cond_destroy(&async->frame_ready);
+  async_mutex_destroy(&async->lock);
+  for (int i = 0; i < TCOD_ASYNC_SLOTS; ++i) TCOD_console_delete(async->frames[i].console);
+  free(async);
+  context->async_ = NULL;
+}
+#endif  // TCOD_NO_THREADS
+TCOD_Error TCOD_context_set_async_present(struct TCOD_Context* context, bool enable) {
+  if (!context) {
+    TCOD_set_errorv("Context must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+#ifdef TCOD_NO_THREADS
+  if (!enable) return TCOD_E_OK;
+  TCOD_set_errorv("Pipelined presentation requires libtcod to be built with thread support.");
+  return TCOD_E_ERROR;
+#else
+  if (!enable) {
+    if (context->async_) async_stop(context);
+    return TCOD_E_OK;
+  }
+  if (context->async_) return TCOD_E_OK;
+  if (!context->c_present_) return TCOD_set_errorv("Context is missing a present method.");
+  if (context->c_get_sdl_window_ || context->c_get_sdl_renderer_) {
+    // SDL windows and renderers may only be used from the thread which created them.
+    return TCOD_set_errorv("Pipelined presentation is not supported by SDL renderers.");
+  }
+  struct TCOD_ContextAsync_* async = calloc(1, sizeof(*async));
+  if (!async) {
+    TCOD_set_errorv("Could not allocate memory.");
+    return TCOD_E_OUT_OF_MEMORY;
+  }
+  async->pending = -1;
+  async->rendering = -1;
+  async_mutex_init(&async->lock);
+  async_cond_init(&async->frame_ready);
+  async_cond_init(&async->frame_done);
+  context->async_ = async;
+#if defined(_WIN32)
+  async->thread = CreateThread(NULL, 0, async_thread_main, context, 0, NULL);
+  const bool started = async->thread != NULL;
+#else
+  const bool started = pthread_create(&async->thread, NULL, async_thread_main, context) == 0;
+#endif
+  if (!started) {
+    async_cond_destroy(&async->frame_done);
+    async_cond_destroy(&async->frame_ready);
+    async_mutex_destroy(&async->lock);
+    free(async);
+    context->async_ = NULL;
+    return TCOD_set_errorv("Could not start the render thread.");
+  }
+  return TCOD_E_OK;
+#endif  // TCOD_NO_THREADS
+}
+TCOD_Error TCOD_context_async_present_(
+    struct TCOD_Context* context, const TCOD_Console* console, const struct TCOD_ViewportOptions* viewport) {
+#ifdef TCOD_NO_THREADS
+  return context->c_present_(context, console, viewport);
+#else
+  struct TCOD_ContextAsync_* async = context->async_;
+  async_mutex_lock(&async->lock);
+  const TCOD_Error err = async->error;
+  if (err < 0) TCOD_set_error(async->error_msg);
+  async->error = TCOD_E_OK;
+  int free_i = 0;  // Only this thread makes frames pending, so the free frame can't be taken until it's pending.
+  while (free_i == async->pending || free_i == async->rendering) ++free_i;
+  async_mutex_unlock(&async->lock);
+
+  struct AsyncFrame* frame = &async->frames[free_i];
+  if (frame->console && (frame->console->w != console->w || frame->console->h != console->h)) {
+    TCOD_console_delete(frame->console);
+    frame->console = NULL;
+  }
+  if (!frame->console) {
+    frame->console = TCOD_console_new(console->w, console->h);
+    if (!frame->console) {
+      TCOD_set_errorv("Could not allocate memory.");
+      return TCOD_E_OUT_OF_MEMORY;
+    }
+  }
+  memcpy(frame->console->tiles, console->tiles, sizeof(*console->tiles) * console->elements);
+  frame->has_viewport = viewport != NULL;
+  if (viewport) frame->viewport = *viewport;
+
+  async_mutex_lock(&async->lock);
+  async->pending = free_i;  // Replaces any frame which didn't start rendering in time.
+  async_cond_broadcast(&async->frame_ready);
+  async_mutex_unlock(&async->lock);
+  return err < 0 ? err : TCOD_E_OK;
+#endif  // TCOD_NO_THREADS
+}
+void TCOD_context_async_pixel_to_tile_(struct TCOD_Context* context, double* x, double* y) {
+#ifndef TCOD_NO_THREADS
+  struct TCOD_ContextAsync_* async = context->async_;
+  if (async) {
+    async_mutex_lock(&async->lock);  // Does not wait for pending frames, the lock is never held while rendering.
+    context->c_pixel_to_tile_(context, x, y);
+    async_mutex_unlock(&async->lock);
+    return;
+  }
+#endif  // TCOD_NO_THREADS
+  context->c_pixel_to_tile_(context, x, y);
+}
+void TCOD_context_async_sync_(struct TCOD_Context* context) {
+#ifndef TCOD_NO_THREADS
+  if (!context || !context->async_) return;
+  struct TCOD_ContextAsync_* async = context->async_;
+  async_mutex_lock(&async->lock);
+  while (async->pending >= 0 || async->rendering >= 0) async_cond_wait(&async->frame_done, &async->lock);
+  async_mutex_unlock(&async->lock);
+#else
+  (void)context;
+#endif  // TCOD_NO_THREADS
+}
@@ -41,6 +41,7 @@
 #include "globals.h"
 #include "libtcod_int.h"
 #include "logging.h"
+#include "renderer_headless.h"
 #include "renderer_sdl2.h"
 #include "renderer_xterm.h"
 #include "tileset_fallback.h"
@@ -80,6 +81,8 @@ static int get_renderer_from_str(const char* string) {
     return TCOD_RENDERER_OPENGL2;
   } else if (strcmp(string, "xterm") == 0) {
     return TCOD_RENDERER_XTERM;
+  } else if (strcmp(string, "headless") == 0) {
+    return TCOD_RENDERER_HEADLESS;
   } else {
     return -1;
   }
@@ -223,8 +226,8 @@ static TCOD_Error parse_context_parameters(const TCOD_ContextParams* in, TCOD_Co
       if (++i < out->argc && get_renderer_from_str(out->argv[i]) >= 0) {
         out->renderer_type = get_renderer_from_str(out->argv[i]);
       } else {
-        TCOD_set_error("Renderer should be one of [sdl|sdl2|opengl|opengl2|xterm]");
-        return send_to_cli_out(out, "Renderer should be one of [sdl|sdl2|opengl|opengl2|xterm]");
+        TCOD_set_error("Renderer should be one of [sdl|sdl2|opengl|opengl2|xterm|headless]");
+        return send_to_cli_out(out, "Renderer should be one of [sdl|sdl2|opengl|opengl2|xterm|headless]");
       }
     } else if (TCOD_CHECK_ARGUMENT(out->argv[i], "resolution")) {
       if (++i < out->argc && sscanf(out->argv[i], "%dx%d", &out->pixel_width, &out->pixel_height) == 2) {
@@ -304,6 +307,10 @@ TCOD_Error TCOD_context_new(const TCOD_ContextParams* params_in, TCOD_Context**
           params.window_title);
       if (!*out) return TCOD_E_ERROR;
       return err;
+    case TCOD_RENDERER_HEADLESS:
+      *out = TCOD_renderer_init_headless(params.pixel_width, params.pixel_height, params.tileset);
+      if (!*out) return TCOD_E_ERROR;
+      return err;
   }
 }
 #endif  // NO_SDL
@@ -77,6 +77,27 @@ struct TCOD_ViewportOptions {
   float align_y;
 };
 typedef struct TCOD_ViewportOptions TCOD_ViewportOptions;
+/**
+    Resampling filters for tiles which are pre-scaled to the size they're displayed at.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+typedef enum TCOD_ScaleFilter {
+  /**
+      Tiles are not pre-scaled.  The console is rendered at the tileset size and then stretched to the viewport.
+   */
+  TCOD_SCALE_FILTER_NONE = 0,
+  /**
+      Each tileset pixel becomes a square block of pixels.
+   */
+  TCOD_SCALE_FILTER_NEAREST = 1,
+  /**
+      Tiles are enlarged with bilinear interpolation.
+   */
+  TCOD_SCALE_FILTER_LINEAR = 2,
+} TCOD_ScaleFilter;
 /**
     Default viewport options if none are provided.
  */
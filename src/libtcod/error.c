@@ -35,10 +35,12 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "libtcod_int.h"
+
 // Maximum error length in bytes.
 #define MAX_ERROR_LENGTH 1024
-// Current error message.
-static char error_msg_[MAX_ERROR_LENGTH] = "";
+// Current error message of this thread.
+static TCOD_THREAD_LOCAL_ char error_msg_[MAX_ERROR_LENGTH] = "";
 
 const char* TCOD_get_error(void) { return error_msg_; }
 int TCOD_set_error(const char* msg) {
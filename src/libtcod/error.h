@@ -84,8 +84,12 @@ extern "C" {
 /***************************************************************************
     @brief Return the last error message.  If there is no error then the string will have a length of zero.
 
+    Each thread has its own error message.
+
     \rst
     .. versionadded:: 1.12
+    .. versionchanged:: Unreleased
+        Error messages are stored per thread.
     \endrst
  */
 TCOD_NODISCARD
@@ -89,6 +89,34 @@ TCOD_PUBLIC void TCOD_map_delete(TCOD_Map* map);
  */
 TCOD_PUBLIC TCOD_Error TCOD_map_compute_fov(
     TCOD_Map* __restrict map, int pov_x, int pov_y, int max_radius, bool light_walls, TCOD_fov_algorithm_t algo);
+/**
+    Calculate a 3D field-of-view over a stack of maps.
+
+    \rst
+    `maps` is an array of `levels` maps which must all have the same width and height.
+    Each map is one z-level of the volume, with ``maps[0]`` as the lowest level.
+    Cells block the view between levels the same way they block it within a level,
+    so a transparent cell over another transparent cell works as an open pit and the floor of a level is an opaque
+    cell on the level below it.
+
+    `pov_x`, `pov_y`, and `pov_z` are used as the field-of-view source, where `pov_z` is an index of `maps`.
+    These coordinates must be within the volume.
+
+    `max_radius` and `light_walls` work the same as in :any:`TCOD_map_compute_fov`.
+
+    This is a volumetric version of the ``FOV_SYMMETRIC_SHADOWCAST`` algorithm.
+    With a single level the results are the same as the 2D algorithm.
+
+    After this call you may check if a cell on any level is within the field-of-view by calling
+    :any:`TCOD_map_is_in_fov` on the map of that level.
+
+    Returns an error code on failure.  See :any:`TCOD_get_error` for details.
+
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_map_compute_fov_3d(
+    TCOD_Map* const* maps, int levels, int pov_x, int pov_y, int pov_z, int max_radius, bool light_walls);
 /**
     Return true if this cell was touched by the current field-of-view.
  */
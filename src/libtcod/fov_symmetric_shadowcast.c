@@ -40,6 +40,7 @@
 
 #include "fov.h"
 #include "libtcod_int.h"
+#include "utility.h"
 /**
     Quadrant transformation matrixes.
 
@@ -62,6 +63,12 @@ typedef struct Row {
   float slope_low;
   const float slope_high;
 } Row;
+/**
+    Returns true if `column` at `depth` is between the `low` and `high` slopes.
+ */
+static bool is_between_slopes(int depth, float low, float high, int column) {
+  return column >= depth * low && column <= depth * high;
+}
 /**
     Returns true if a given floor tile can be seen symmetrically from the origin.
 
@@ -69,7 +76,7 @@ typedef struct Row {
     by the row’s start and end slopes. Otherwise, it returns false.
  */
 static bool is_symmetric(const Row* __restrict row, int column) {
-  return column >= row->depth * row->slope_low && column <= row->depth * row->slope_high;
+  return is_between_slopes(row->depth, row->slope_low, row->slope_high, column);
 }
 /**
     Calculates new start and end slopes.
@@ -177,3 +184,218 @@ TCOD_Error TCOD_map_compute_fov_symmetric_shadowcast(
   }
   return TCOD_E_OK;
 }
+/**
+    Axis tables for the six pyramids of a volume.
+
+    {major_axis, major_direction, u_axis, u_direction, v_axis}
+
+    The horizontal pyramids are transformed the same way as `quadrant_table`.
+ */
+static const int pyramid_table[6][5] = {
+    {0, 1, 1, 1, 2},
+    {1, 1, 0, 1, 2},
+    {1, -1, 0, -1, 2},
+    {0, -1, 1, -1, 2},
+    {2, 1, 0, 1, 1},
+    {2, -1, 0, -1, 1},
+};
+/**
+    A stack of maps treated as a single volume.
+ */
+typedef struct Volume {
+  TCOD_Map* const* maps;  // One map per z-level.
+  int shape[3];  // {width, height, levels}
+  int max_depth;  // Scans stop after this depth, or never if zero.
+} Volume;
+/**
+    The active view window of a pyramid, this is the 3D version of `Row`.
+
+    The window is a rectangle of `u` and `v` slopes.
+ */
+typedef struct Window {
+  int pov[3];  // The origin point-of-view.
+  int pyramid;  // The pyramid index.
+  int depth;  // The depth of this window.
+  float u_low;
+  float u_high;
+  float v_low;
+  float v_high;
+} Window;
+/**
+    Return the map cell at `u`, `v` of the current window, or NULL if it's out-of-bounds.
+ */
+static struct TCOD_MapCell* get_cell_3d(
+    const Volume* __restrict volume, const Window* __restrict window, int u, int v) {
+  const int* pyramid = pyramid_table[window->pyramid];
+  int xyz[3] = {window->pov[0], window->pov[1], window->pov[2]};
+  xyz[pyramid[0]] += pyramid[1] * window->depth;
+  xyz[pyramid[2]] += pyramid[3] * u;
+  xyz[pyramid[4]] += v;
+  for (int axis = 0; axis < 3; ++axis) {
+    if (xyz[axis] < 0 || xyz[axis] >= volume->shape[axis]) return NULL;
+  }
+  return &volume->maps[xyz[2]]->cells[xyz[0] + xyz[1] * volume->shape[0]];
+}
+/**
+    Return true if the cell at `u`, `v` is in-bounds and transparent.
+ */
+static bool is_transparent_3d(const Volume* __restrict volume, const Window* __restrict window, int u, int v) {
+  const struct TCOD_MapCell* cell = get_cell_3d(volume, window, u, v);
+  return cell && cell->transparent;
+}
+/**
+    Return true if rows `v0` and `v1` have the same transparency between `u_min` and `u_max`.
+ */
+static bool rows_match_3d(
+    const Volume* __restrict volume, const Window* __restrict window, int u_min, int u_max, int v0, int v1) {
+  for (int u = u_min; u <= u_max; ++u) {
+    if (is_transparent_3d(volume, window, u, v0) != is_transparent_3d(volume, window, u, v1)) return false;
+  }
+  return true;
+}
+/**
+    Scan a window and recursively scan the windows behind it.
+
+    A window without walls continues to the next depth unchanged.  Otherwise the window is split into bands of
+    matching rows, and each run of transparent tiles in a band becomes a new window for the next depth.
+ */
+static void scan_3d(const Volume* __restrict volume, Window* __restrict window) {
+  const int* pyramid = pyramid_table[window->pyramid];
+  const int major = window->pov[pyramid[0]] + pyramid[1] * window->depth;
+  if (major < 0 || major >= volume->shape[pyramid[0]]) {
+    return;  // Window->depth is out-of-bounds.
+  }
+  if (volume->max_depth > 0 && window->depth > volume->max_depth) {
+    return;  // Window->depth is outside of the radius.
+  }
+  const int depth = window->depth;
+  const int u_min = round_half_up(depth * window->u_low);
+  const int u_max = round_half_down(depth * window->u_high);
+  const int v_min = round_half_up(depth * window->v_low);
+  const int v_max = round_half_down(depth * window->v_high);
+  bool has_walls = false;
+  for (int v = v_min; v <= v_max; ++v) {
+    for (int u = u_min; u <= u_max; ++u) {
+      struct TCOD_MapCell* cell = get_cell_3d(volume, window, u, v);
+      if (!cell || !cell->transparent) {
+        has_walls = true;  // Out-of-bounds tiles are treated as walls.
+        if (cell) cell->fov = true;
+        continue;
+      }
+      if (is_between_slopes(depth, window->u_low, window->u_high, u) &&
+          is_between_slopes(depth, window->v_low, window->v_high, v)) {
+        cell->fov = true;
+      }
+    }
+  }
+  if (!has_walls) {
+    // Tail recuse into the next depth.
+    window->depth += 1;
+    scan_3d(volume, window);
+    return;
+  }
+  int band_start = v_min;
+  while (band_start <= v_max) {
+    int band_end = band_start;
+    while (band_end < v_max && rows_match_3d(volume, window, u_min, u_max, band_end, band_end + 1)) {
+      ++band_end;
+    }
+    const float v_low = MAX(window->v_low, slope(depth, band_start));
+    const float v_high = MIN(window->v_high, slope(depth, band_end + 1));
+    for (int u = u_min; u <= u_max; ++u) {
+      if (!is_transparent_3d(volume, window, u, band_start)) {
+        continue;
+      }
+      int run_end = u;
+      while (run_end < u_max && is_transparent_3d(volume, window, run_end + 1, band_start)) {
+        ++run_end;
+      }
+      Window next_window = {
+          .pov = {window->pov[0], window->pov[1], window->pov[2]},
+          .pyramid = window->pyramid,
+          .depth = depth + 1,
+          .u_low = MAX(window->u_low, slope(depth, u)),
+          .u_high = MIN(window->u_high, slope(depth, run_end + 1)),
+          .v_low = v_low,
+          .v_high = v_high,
+      };
+      if (next_window.u_low <= next_window.u_high && next_window.v_low <= next_window.v_high) {
+        scan_3d(volume, &next_window);
+      }
+      u = run_end;
+    }
+    band_start = band_end + 1;
+  }
+}
+
+TCOD_Error TCOD_map_compute_fov_3d(
+    TCOD_Map* const* maps, int levels, int pov_x, int pov_y, int pov_z, int max_radius, bool light_walls) {
+  if (!maps || levels <= 0) {
+    TCOD_set_errorv("Maps must not be NULL or empty.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  for (int z = 0; z < levels; ++z) {
+    if (!maps[z]) {
+      TCOD_set_errorvf("Map at level %i must not be NULL.", z);
+      return TCOD_E_INVALID_ARGUMENT;
+    }
+    if (maps[z]->width != maps[0]->width || maps[z]->height != maps[0]->height) {
+      TCOD_set_errorvf(
+          "Map at level %i has a shape of {%i, %i} but {%i, %i} was expected.",
+          z,
+          maps[z]->width,
+          maps[z]->height,
+          maps[0]->width,
+          maps[0]->height);
+      return TCOD_E_INVALID_ARGUMENT;
+    }
+  }
+  if (!TCOD_map_in_bounds(maps[0], pov_x, pov_y) || pov_z < 0 || pov_z >= levels) {
+    TCOD_set_errorvf("Point of view {%i, %i, %i} is out of bounds.", pov_x, pov_y, pov_z);
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  const Volume volume = {
+      .maps = maps,
+      .shape = {maps[0]->width, maps[0]->height, levels},
+      .max_depth = max_radius,
+  };
+  for (int z = 0; z < levels; ++z) {
+    for (int i = 0; i < maps[z]->nbcells; ++i) {
+      maps[z]->cells[i].fov = false;
+    }
+  }
+  maps[pov_z]->cells[pov_x + pov_y * maps[pov_z]->width].fov = true;
+  for (int pyramid = 0; pyramid < 6; ++pyramid) {
+    Window window = {
+        .pov = {pov_x, pov_y, pov_z},
+        .pyramid = pyramid,
+        .depth = 1,
+        .u_low = -1.0f,
+        .u_high = 1.0f,
+        .v_low = -1.0f,
+        .v_high = 1.0f,
+    };
+    scan_3d(&volume, &window);
+  }
+  const int radius_squared = max_radius * max_radius;
+  for (int z = 0; z < levels; ++z) {
+    TCOD_Map* map = maps[z];
+    for (int y = 0; y < map->height; ++y) {
+      for (int x = 0; x < map->width; ++x) {
+        int i = x + y * map->width;
+        if (!light_walls && !map->cells[i].transparent) {
+          map->cells[i].fov = false;
+        }
+        if (max_radius > 0) {
+          const int dx = x - pov_x;
+          const int dy = y - pov_y;
+          const int dz = z - pov_z;
+          if (dx * dx + dy * dy + dz * dz >= radius_squared) {
+            map->cells[i].fov = false;
+          }
+        }
+      }
+    }
+  }
+  return TCOD_E_OK;
+}
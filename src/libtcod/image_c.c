@@ -879,6 +879,7 @@ void TCOD_image_blit_2x(
       }
       /* analyze color, posterize, get pattern */
       console->tiles[console_y * console->w + console_x] = generate_quadrant_graphic(grid);
+      TCOD_console_mark_dirty(console, console_x, console_y, 1, 1);
     }
   }
 }
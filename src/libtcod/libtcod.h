@@ -36,11 +36,13 @@
 #include "bsp.h"
 #include "color.h"
 #include "console.h"
+#include "console_compact.h"
 #include "console_drawing.h"
 #include "console_etc.h"
 #include "console_init.h"
 #include "console_printing.h"
 #include "console_rexpaint.h"
+#include "console_stack.h"
 #include "context.h"
 #include "context_init.h"
 #include "error.h"
@@ -61,11 +63,13 @@
 #include "pathfinder_frontier.h"
 #include "portability.h"
 #include "random.h"
+#include "renderer_headless.h"
 #include "renderer_sdl2.h"
 #include "sdl2/event.h"
 #include "sys.h"
 #include "tileset.h"
 #include "tileset_bdf.h"
+#include "tileset_cache.h"
 #include "tileset_fallback.h"
 #include "tileset_render.h"
 #include "tileset_truetype.h"
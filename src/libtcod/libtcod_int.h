@@ -112,6 +112,8 @@ typedef struct TCOD_internal_context_t {
    */
   struct TCOD_Tileset* tileset;
   struct TCOD_Context* engine;
+  /** Scratch console reused by TCOD_console_flush_ex to present faded consoles, or NULL. */
+  struct TCOD_Console* fade_console;
 } TCOD_internal_context_t;
 
 extern TCOD_internal_context_t TCOD_ctx;
@@ -134,6 +136,17 @@ extern TCOD_internal_context_t TCOD_ctx;
   if (!(cond)) __android_log_assert(#cond, "libtcod", "assertion failed: %s", #cond)
 #endif
 
+/// Storage class for variables with one instance per thread.
+#if defined(__cplusplus)
+#define TCOD_THREAD_LOCAL_ thread_local
+#elif defined(_MSC_VER)
+#define TCOD_THREAD_LOCAL_ __declspec(thread)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#define TCOD_THREAD_LOCAL_ _Thread_local
+#else
+#define TCOD_THREAD_LOCAL_ __thread
+#endif
+
 #ifdef NDEBUG
 #define TCOD_IF(x) if (x)
 #define TCOD_IFNOT(x) if (!(x))
@@ -520,6 +533,45 @@ static inline TCOD_Console* TCOD_console_validate_(const TCOD_Console* console)
 static inline bool TCOD_console_is_index_valid_(const TCOD_Console* console, int x, int y) {
   return console && 0 <= x && x < console->w && 0 <= y && y < console->h;
 }
+/**
+ *  Record a write to the tile at `x`,`y` if the console is tracking writes.  The index must be valid.
+ */
+static inline void TCOD_console_touch_(TCOD_Console* console, int x, int y) {
+  if (!console->dirty_rows) {
+    return;
+  }
+  TCOD_ConsoleDirtySpan* span = &console->dirty_rows[y];
+  if (x < span->begin) span->begin = x;
+  if (x >= span->end) span->end = x + 1;
+}
+/**
+ *  Return the columns of row `y` which need to be compared and redrawn when rendering `console` onto `cache`.
+ *
+ *  This is the entire row unless both consoles are tracking writes and `cache` last rendered `console`.
+ *  `cache` can be NULL.
+ */
+TCOD_ConsoleDirtySpan TCOD_console_get_redraw_span_(const TCOD_Console* console, const TCOD_Console* cache, int y);
+/**
+ *  Mark the tracked writes of `console` and `cache` as consumed after `console` was rendered onto `cache`.
+ */
+void TCOD_console_end_redraw_(const TCOD_Console* console, TCOD_Console* cache);
+/**
+ *  Queue `console` to be presented by the render thread of a context with pipelined presentation enabled.
+ */
+TCOD_Error TCOD_context_async_present_(
+    struct TCOD_Context* context, const TCOD_Console* console, const struct TCOD_ViewportOptions* viewport);
+/**
+ *  Convert pixel coordinates to tile coordinates while holding the pipelined presentation lock of `context`.
+ *
+ *  Unlike `TCOD_context_async_sync_` this does not wait for pending frames.
+ */
+void TCOD_context_async_pixel_to_tile_(struct TCOD_Context* context, double* x, double* y);
+/**
+ *  Wait until the render thread of `context` has finished all pending frames.
+ *
+ *  Does nothing if pipelined presentation is not enabled.
+ */
+void TCOD_context_async_sync_(struct TCOD_Context* context);
 TCOD_event_t TCOD_sys_handle_mouse_event(const union SDL_Event* ev, TCOD_mouse_t* mouse);
 TCOD_event_t TCOD_sys_handle_key_event(const union SDL_Event* ev, TCOD_key_t* key);
 #ifdef __cplusplus
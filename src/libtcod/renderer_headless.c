@@ -0,0 +1,207 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice and the libtcod contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "renderer_headless.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "console.h"
+#include "console_types.h"
+#include "error.h"
+#include "libtcod_int.h"
+#include "tileset_render.h"
+
+/**
+    The renderer data for a headless rendering context.
+ */
+struct TCOD_RendererHeadless {
+  TCOD_Tileset* tileset;  // Reference counted tileset.
+  TCOD_Console* cache_console;  // Tracks the data from the last console presented.
+  TCOD_ColorRGBA* pixels;  // Owning pointer to the framebuffer, `width * height` pixels.
+  int width;  // Framebuffer width in pixels.
+  int height;  // Framebuffer height in pixels.
+  int pixel_width;  // Nominal output width used for console size recommendations.
+  int pixel_height;  // Nominal output height used for console size recommendations.
+};
+/**
+    Resize the framebuffer to fit `console`.  Contents are undefined after a resize.
+ */
+static TCOD_Error headless_resize(
+    struct TCOD_RendererHeadless* __restrict data, const TCOD_Console* __restrict console) {
+  const int width = console->w * data->tileset->tile_width;
+  const int height = console->h * data->tileset->tile_height;
+  if (data->pixels && data->width == width && data->height == height) return TCOD_E_OK;
+  TCOD_ColorRGBA* pixels = malloc(sizeof(*pixels) * (width > 0 ? width : 1) * (height > 0 ? height : 1));
+  if (!pixels) {
+    TCOD_set_errorv("Could not allocate memory.");
+    return TCOD_E_OUT_OF_MEMORY;
+  }
+  free(data->pixels);
+  data->pixels = pixels;
+  data->width = width;
+  data->height = height;
+  if (data->cache_console) {
+    TCOD_console_delete(data->cache_console);  // The cache no longer matches the framebuffer.
+    data->cache_console = NULL;
+  }
+  return TCOD_E_OK;
+}
+/**
+    Render `console` to the framebuffer.  The viewport is ignored.
+ */
+static TCOD_Error headless_accumulate(
+    struct TCOD_Context* __restrict self,
+    const struct TCOD_Console* __restrict console,
+    const struct TCOD_ViewportOptions* __restrict viewport) {
+  (void)viewport;  // Output is always at the consoles native resolution.
+  struct TCOD_RendererHeadless* data = self->contextdata_;
+  const TCOD_Error err = headless_resize(data, console);
+  if (err < 0) return err;
+  // Missing tiles were already requested by c_request_tiles_, the tileset is only read here.
+  return TCOD_tileset_render_to_rgba(
+      data->tileset, console, &data->cache_console, data->pixels, data->width * (int)sizeof(*data->pixels));
+}
+/**
+    Load the tiles of `console` on the presenting thread.
+ */
+static TCOD_Error headless_request_tiles(
+    struct TCOD_Context* __restrict self, const struct TCOD_Console* __restrict console) {
+  const struct TCOD_RendererHeadless* data = self->contextdata_;
+  return TCOD_tileset_request_console_tiles(data->tileset, console);
+}
+static void headless_pixel_to_tile(struct TCOD_Context* __restrict self, double* __restrict x, double* __restrict y) {
+  const struct TCOD_RendererHeadless* data = self->contextdata_;
+  *x /= data->tileset->tile_width;
+  *y /= data->tileset->tile_height;
+}
+static TCOD_Error headless_screen_capture(
+    struct TCOD_Context* __restrict self,
+    TCOD_ColorRGBA* __restrict out_pixels,
+    int* __restrict width,
+    int* __restrict height) {
+  const struct TCOD_RendererHeadless* data = self->contextdata_;
+  if (!data->pixels) {
+    TCOD_set_errorv("Nothing to save before the first frame.");
+    *width = 0;
+    *height = 0;
+    return TCOD_E_WARN;
+  }
+  if (!out_pixels) {
+    *width = data->width;
+    *height = data->height;
+    return TCOD_E_OK;
+  }
+  if (*width != data->width || *height != data->height) {
+    TCOD_set_errorv("width or height do not match the size of the screen.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  memcpy(out_pixels, data->pixels, sizeof(*out_pixels) * data->width * data->height);
+  return TCOD_E_OK;
+}
+static TCOD_Error headless_set_tileset(struct TCOD_Context* __restrict self, TCOD_Tileset* __restrict tileset) {
+  struct TCOD_RendererHeadless* data = self->contextdata_;
+  if (!tileset) {
+    TCOD_set_errorv("Tileset must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  ++tileset->ref_count;
+  TCOD_tileset_delete(data->tileset);
+  data->tileset = tileset;
+  free(data->pixels);  // Tile sizes may have changed, the next frame reallocates.
+  data->pixels = NULL;
+  data->width = data->height = 0;
+  if (data->cache_console) {
+    TCOD_console_delete(data->cache_console);
+    data->cache_console = NULL;
+  }
+  return TCOD_E_OK;
+}
+static TCOD_Error headless_recommended_console_size(
+    struct TCOD_Context* __restrict self, float magnification, int* __restrict columns, int* __restrict rows) {
+  const struct TCOD_RendererHeadless* data = self->contextdata_;
+  if (columns && data->tileset->tile_width * magnification != 0) {
+    *columns = (int)(data->pixel_width / (data->tileset->tile_width * magnification));
+  }
+  if (rows && data->tileset->tile_height * magnification != 0) {
+    *rows = (int)(data->pixel_height / (data->tileset->tile_height * magnification));
+  }
+  return TCOD_E_OK;
+}
+static void headless_destructor(struct TCOD_Context* __restrict self) {
+  struct TCOD_RendererHeadless* data = self->contextdata_;
+  if (!data) return;
+  TCOD_console_delete(data->cache_console);
+  free(data->pixels);
+  TCOD_tileset_delete(data->tileset);
+  free(data);
+}
+TCOD_Context* TCOD_renderer_init_headless(int pixel_width, int pixel_height, TCOD_Tileset* tileset) {
+  if (!tileset) {
+    TCOD_set_errorv("Tileset must not be NULL.");
+    return NULL;
+  }
+  TCOD_Context* context = TCOD_context_new_();
+  if (!context) {
+    TCOD_set_errorv("Could not allocate memory.");
+    return NULL;
+  }
+  context->type = TCOD_RENDERER_HEADLESS;
+  struct TCOD_RendererHeadless* data = context->contextdata_ = calloc(sizeof(*data), 1);
+  if (!data) {
+    TCOD_context_delete(context);
+    TCOD_set_errorv("Could not allocate memory.");
+    return NULL;
+  }
+  data->pixel_width = pixel_width;
+  data->pixel_height = pixel_height;
+  context->c_destructor_ = headless_destructor;
+  context->c_present_ = headless_accumulate;
+  context->c_accumulate_ = headless_accumulate;
+  context->c_pixel_to_tile_ = headless_pixel_to_tile;
+  context->c_request_tiles_ = headless_request_tiles;
+  context->c_screen_capture_ = headless_screen_capture;
+  context->c_set_tileset_ = headless_set_tileset;
+  context->c_recommended_console_size_ = headless_recommended_console_size;
+  if (context->c_set_tileset_(context, tileset) < 0) {
+    TCOD_context_delete(context);
+    return NULL;
+  }
+  return context;
+}
+const TCOD_ColorRGBA* TCOD_renderer_headless_get_pixels(const TCOD_Context* context, int* width, int* height) {
+  if (!context || context->type != TCOD_RENDERER_HEADLESS || !context->contextdata_) return NULL;
+  TCOD_context_async_sync_((TCOD_Context*)context);  // Only waits, the context is not modified.
+  const struct TCOD_RendererHeadless* data = context->contextdata_;
+  if (width) *width = data->pixels ? data->width : 0;
+  if (height) *height = data->pixels ? data->height : 0;
+  return data->pixels;
+}
@@ -0,0 +1,81 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice and the libtcod contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LIBTCOD_RENDERER_HEADLESS_H_
+#define LIBTCOD_RENDERER_HEADLESS_H_
+#include "color.h"
+#include "config.h"
+#include "context.h"
+#include "tileset.h"
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+/**
+    Return a libtcod rendering context which renders to an in-memory RGBA framebuffer.
+
+    No window is opened and no video driver is required.  Consoles are drawn
+    with `tileset` at their native resolution, one tile per cell, and the
+    viewport options given to `TCOD_context_present` are ignored.
+
+    `pixel_width` and `pixel_height` are only used to derive
+    `TCOD_context_recommended_console_size`.
+
+    `tileset` must not be NULL, this context will hold a reference to it.
+
+    Returns NULL on error, see `TCOD_get_error`.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_NODISCARD TCOD_Context* TCOD_renderer_init_headless(
+    int pixel_width, int pixel_height, TCOD_Tileset* tileset);
+/**
+    Return a pointer to the last frame rendered by a headless context without copying it.
+
+    `width` and `height` are optional and will be set to the size of the frame
+    in pixels.  Rows are tightly packed, `width` pixels per row.
+
+    The pointer is owned by `context` and is invalidated by the next call to
+    `TCOD_context_present` or when `context` is deleted.  With pipelined
+    presentation this waits for pending frames to finish first.
+
+    Returns NULL if `context` is not a headless context or if nothing has been
+    presented yet.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC const TCOD_ColorRGBA* TCOD_renderer_headless_get_pixels(
+    const TCOD_Context* context, int* width, int* height);
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+#endif  // LIBTCOD_RENDERER_HEADLESS_H_
@@ -36,8 +36,10 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "libtcod_int.h"
+#include "utility.h"
 
 #define BUFFER_TILES_MAX 10922  // Max number of tiles to buffer. (65536 / 6) to fit indices in a uint16_t type.
 /// Vertex element with position and color data.  Position uses pixel coordinates.
@@ -51,96 +53,442 @@ typedef struct VertexUV {
   float u;
   float v;
 } VertexUV;
-/// A fixed-size dynamic buffer for vertex data.
+/// A fixed-size dynamic buffer for vertex data.  Owned by an atlas and reused across renders.
 /// Vertices are ordered: upper-left, lower-left, upper-right, lower-right.
-typedef struct VertexBuffer {
+typedef struct TCOD_VertexBufferSDL2 {
   int16_t index;  // Next tile to assign to.  Groups indicies in sets of 6 and vertices in sets of 4.
-  int16_t indices_initialized;  // Sets of indicies initialized.
+  int page;  // The atlas page which buffered foreground quads sample from.
   uint16_t indices[BUFFER_TILES_MAX * 6];  // Vertex indices.  Vertex quads are assigned as: 0 1 2, 2 1 3.
   VertexElement vertex[BUFFER_TILES_MAX * 4];
   VertexUV vertex_uv[BUFFER_TILES_MAX * 4];
 } VertexBuffer;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+/// Return a new vertex buffer with all of its indices assigned, or NULL on failure.
+static VertexBuffer* vertex_buffer_new(void) {
+  VertexBuffer* buffer = malloc(sizeof(*buffer));
+  if (!buffer) return NULL;
+  buffer->index = 0;
+  for (int i = 0; i < BUFFER_TILES_MAX; ++i) {
+    buffer->indices[i * 6 + 0] = (uint16_t)(i * 4);
+    buffer->indices[i * 6 + 1] = (uint16_t)(i * 4 + 1);
+    buffer->indices[i * 6 + 2] = (uint16_t)(i * 4 + 2);
+    buffer->indices[i * 6 + 3] = (uint16_t)(i * 4 + 2);
+    buffer->indices[i * 6 + 4] = (uint16_t)(i * 4 + 1);
+    buffer->indices[i * 6 + 5] = (uint16_t)(i * 4 + 3);
+  }
+  return buffer;
+}
+#endif  // SDL_VERSION_ATLEAST(2, 0, 18)
 
 static inline float minf(float a, float b) { return a < b ? a : b; }
 static inline float maxf(float a, float b) { return a > b ? a : b; }
 static inline float clampf(float v, float low, float high) { return maxf(low, minf(v, high)); }
 // ----------------------------------------------------------------------------
 // SDL2 Atlas
+#define TCOD_SDL2_ATLAS_MAX_PAGES 4  // Most textures an atlas will use before it starts evicting glyphs.
+#define TCOD_SDL2_ATLAS_MIN_PAGE_SIZE 512  // Smallest page texture, big enough that a few pages hold most fonts.
+#define TCOD_SDL2_ATLAS_MAX_PAGE_SIZE 4096  // Largest page texture, smaller if the renderer has a lower limit.
+/// A tile position on one of the atlas pages.
+typedef struct AtlasSlot {
+  int tile_id;  // The tile held by this slot, or -1 if unassigned.
+  int prev;  // The next more recently used slot, or -1.
+  int next;  // The next less recently used slot, or -1.
+  uint32_t frame;  // The last render which drew this slot.
+} AtlasSlot;
+/// Tracks which tiles are resident on the atlas textures.  Owned by an atlas.
+/// Slots are numbered across all pages, the last slot of every page is reserved for a solid white tile.
+typedef struct TCOD_AtlasPagesSDL2 {
+  int scale;  // Tiles are stored this many times larger than the tileset.
+  TCOD_ScaleFilter filter;  // How tiles are resampled when scale is above 1.
+  int tile_width;  // Width of a slot in pixels.  The tileset tile width times scale.
+  int tile_height;  // Height of a slot in pixels.  The tileset tile height times scale.
+  int page_size;  // Width and height of each page texture in pixels.
+  int columns;  // Tile columns on a page.
+  int slots_per_page;  // Tile slots on a page, including the white tile.
+  int page_count;
+  SDL_Texture* pages[TCOD_SDL2_ATLAS_MAX_PAGES];
+  int slots_used;  // Slots below this index have been handed out at least once.
+  AtlasSlot* slots;  // Array of slots_per_page * page_count slots.
+  int* pending;  // Slots waiting to be uploaded by upload_sdl2_atlas_pending, up to one per slot.
+  int pending_length;
+  TCOD_ColorRGBA* staging;  // Pixels for the rectangle being uploaded.
+  int staging_length;
+  int lru_head;  // The most recently used slot, or -1.
+  int lru_tail;  // The least recently used slot, or -1.
+  int tile_slots_length;
+  int* tile_slots;  // The slot holding each tile, or -1 if that tile isn't resident.
+  uint32_t frame;  // Incremented by each render.
+} AtlasPages;
+static int compare_int_(const void* a, const void* b) {
+  const int lhs = *(const int*)a;
+  const int rhs = *(const int*)b;
+  return (lhs > rhs) - (lhs < rhs);
+}
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+static void vertex_buffer_flush(VertexBuffer* __restrict buffer, const TCOD_TilesetAtlasSDL2* __restrict atlas);
+#endif  // SDL_VERSION_ATLEAST(2, 0, 18)
 /**
- *  Return a rectangle shaped for a tile at `x`,`y`.
+ *  Return a rectangle shaped for a tile at `x`,`y`, in the scaled tile size of the atlas.
  */
-static SDL_Rect get_aligned_tile(const struct TCOD_Tileset* __restrict tileset, int x, int y) {
-  SDL_Rect tile_rect = {x * tileset->tile_width, y * tileset->tile_height, tileset->tile_width, tileset->tile_height};
+static SDL_Rect get_aligned_tile(const struct TCOD_TilesetAtlasSDL2* __restrict atlas, int x, int y) {
+  const int tile_width = atlas->pages->tile_width;
+  const int tile_height = atlas->pages->tile_height;
+  SDL_Rect tile_rect = {x * tile_width, y * tile_height, tile_width, tile_height};
   return tile_rect;
 }
-/// Return the rectangle for the tile at `tile_id`.
-static SDL_Rect get_sdl2_atlas_tile(const struct TCOD_TilesetAtlasSDL2* __restrict atlas, int tile_id) {
-  return get_aligned_tile(atlas->tileset, tile_id % atlas->texture_columns, tile_id / atlas->texture_columns);
+/// Return the page texture holding `slot`.
+static SDL_Texture* get_sdl2_atlas_page(const struct TCOD_TilesetAtlasSDL2* __restrict atlas, int slot) {
+  return atlas->pages->pages[slot / atlas->pages->slots_per_page];
+}
+/// Return the rectangle for `slot` on its page texture.
+static SDL_Rect get_sdl2_atlas_slot(const struct TCOD_TilesetAtlasSDL2* __restrict atlas, int slot) {
+  const int index = slot % atlas->pages->slots_per_page;
+  return get_aligned_tile(atlas, index % atlas->pages->columns, index / atlas->pages->columns);
+}
+/// Return the linear interpolation between `a` and `b` by `t` from 0 to 1.
+static TCOD_ColorRGBA lerp_rgba(TCOD_ColorRGBA a, TCOD_ColorRGBA b, float t) {
+  return (TCOD_ColorRGBA){
+      (uint8_t)((float)a.r + ((float)b.r - (float)a.r) * t + 0.5f),
+      (uint8_t)((float)a.g + ((float)b.g - (float)a.g) * t + 0.5f),
+      (uint8_t)((float)a.b + ((float)b.b - (float)a.b) * t + 0.5f),
+      (uint8_t)((float)a.a + ((float)b.a - (float)a.a) * t + 0.5f),
+  };
+}
+/**
+ *  Write a tile resampled to the atlas scale into `out`, whose rows are `out_stride` pixels apart.
+ *
+ *  Writes a solid white tile if `tile_id` is -1.
+ */
+static void write_sdl2_atlas_tile(
+    const struct TCOD_TilesetAtlasSDL2* __restrict atlas, int tile_id, TCOD_ColorRGBA* __restrict out, int out_stride) {
+  const AtlasPages* pages = atlas->pages;
+  const TCOD_Tileset* tileset = atlas->tileset;
+  if (tile_id < 0) {
+    for (int y = 0; y < pages->tile_height; ++y) {
+      for (int x = 0; x < pages->tile_width; ++x) out[y * out_stride + x] = (TCOD_ColorRGBA){255, 255, 255, 255};
+    }
+    return;
+  }
+  const TCOD_ColorRGBA* tile = tileset->pixels + tile_id * tileset->tile_length;
+  const int scale = pages->scale;
+  if (scale == 1 || pages->filter != TCOD_SCALE_FILTER_LINEAR) {
+    for (int y = 0; y < pages->tile_height; ++y) {
+      const TCOD_ColorRGBA* row = tile + (y / scale) * tileset->tile_width;
+      for (int x = 0; x < pages->tile_width; ++x) out[y * out_stride + x] = row[x / scale];
+    }
+    return;
+  }
+  // Sample between the centers of the tileset pixels, clamped to the edges of the tile.
+  const float max_x = (float)(tileset->tile_width - 1);
+  const float max_y = (float)(tileset->tile_height - 1);
+  for (int y = 0; y < pages->tile_height; ++y) {
+    const float source_y = clampf(((float)y + 0.5f) / (float)scale - 0.5f, 0, max_y);
+    const int y0 = (int)source_y;
+    const int y1 = MIN(y0 + 1, tileset->tile_height - 1);
+    for (int x = 0; x < pages->tile_width; ++x) {
+      const float source_x = clampf(((float)x + 0.5f) / (float)scale - 0.5f, 0, max_x);
+      const int x0 = (int)source_x;
+      const int x1 = MIN(x0 + 1, tileset->tile_width - 1);
+      const TCOD_ColorRGBA top =
+          lerp_rgba(tile[y0 * tileset->tile_width + x0], tile[y0 * tileset->tile_width + x1], source_x - (float)x0);
+      const TCOD_ColorRGBA bottom =
+          lerp_rgba(tile[y1 * tileset->tile_width + x0], tile[y1 * tileset->tile_width + x1], source_x - (float)x0);
+      out[y * out_stride + x] = lerp_rgba(top, bottom, source_y - (float)y0);
+    }
+  }
+}
+/// Make sure the staging buffer holds at least `length` pixels.
+static int reserve_sdl2_atlas_staging(AtlasPages* __restrict pages, int length) {
+  if (length <= pages->staging_length) return 0;
+  TCOD_ColorRGBA* new_staging = realloc(pages->staging, sizeof(*new_staging) * length);
+  if (!new_staging) {
+    TCOD_set_errorv("Out of memory.");
+    return TCOD_E_OUT_OF_MEMORY;
+  }
+  pages->staging = new_staging;
+  pages->staging_length = length;
+  return 0;
 }
 /**
- *  Upload a single tile to the atlas texture.
+ *  Upload the tile assigned to `slot`, or a white tile if the slot has no tile, to its page texture.
  */
-static int update_sdl2_tile(struct TCOD_TilesetAtlasSDL2* __restrict atlas, int tile_id) {
-  const SDL_Rect dest = get_sdl2_atlas_tile(atlas, tile_id);
+static int update_sdl2_slot(const struct TCOD_TilesetAtlasSDL2* __restrict atlas, int slot) {
+  AtlasPages* pages = atlas->pages;
+  const SDL_Rect dest = get_sdl2_atlas_slot(atlas, slot);
+  const bool is_white = slot % pages->slots_per_page == pages->slots_per_page - 1;
+  const int tile_id = is_white ? -1 : pages->slots[slot].tile_id;
+  if (pages->scale == 1 && tile_id >= 0) {
+    return SDL_UpdateTexture(
+        get_sdl2_atlas_page(atlas, slot),
+        &dest,
+        atlas->tileset->pixels + (tile_id * atlas->tileset->tile_length),
+        atlas->tileset->tile_width * sizeof(*atlas->tileset->pixels));
+  }
+  const int err = reserve_sdl2_atlas_staging(pages, MAX(pages->tile_width * pages->tile_height, 1));
+  if (err < 0) return err;
+  write_sdl2_atlas_tile(atlas, tile_id, pages->staging, pages->tile_width);
   return SDL_UpdateTexture(
-      atlas->texture,
-      &dest,
-      atlas->tileset->pixels + (tile_id * atlas->tileset->tile_length),
-      atlas->tileset->tile_width * sizeof(*atlas->tileset->pixels));
+      get_sdl2_atlas_page(atlas, slot), &dest, pages->staging, pages->tile_width * (int)sizeof(*pages->staging));
 }
 /**
- *  Setup a atlas texture and upload the tileset graphics.
+ *  Create a new page texture and upload its solid white tile, which is used to draw background colors.
  */
-static int prepare_sdl2_atlas(struct TCOD_TilesetAtlasSDL2* atlas) {
-  if (!atlas) {
-    return -1;
-  }
-  int current_size = 0;
-  if (atlas->texture) {
-    SDL_QueryTexture(atlas->texture, NULL, NULL, &current_size, NULL);
+static int add_sdl2_atlas_page(struct TCOD_TilesetAtlasSDL2* __restrict atlas) {
+  AtlasPages* pages = atlas->pages;
+  if (pages->page_count >= TCOD_SDL2_ATLAS_MAX_PAGES) return -1;
+  const int new_slots_length = pages->slots_per_page * (pages->page_count + 1);
+  AtlasSlot* new_slots = realloc(pages->slots, sizeof(*new_slots) * new_slots_length);
+  if (new_slots) pages->slots = new_slots;
+  int* new_pending = realloc(pages->pending, sizeof(*new_pending) * new_slots_length);
+  if (new_pending) pages->pending = new_pending;
+  if (!new_slots || !new_pending) {
+    TCOD_set_errorv("Out of memory.");
+    return TCOD_E_OUT_OF_MEMORY;
+  }
+  SDL_Texture* texture = SDL_CreateTexture(
+      atlas->renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, pages->page_size, pages->page_size);
+  if (!texture) return TCOD_set_errorvf("SDL error creating atlas texture: %s", SDL_GetError());
+  SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+  pages->pages[pages->page_count++] = texture;
+  atlas->texture = pages->pages[0];
+  return update_sdl2_slot(atlas, pages->page_count * pages->slots_per_page - 1);  // The white tile.
+}
+/// Free the atlas textures and the tracking data for them.
+static void delete_sdl2_atlas_pages(AtlasPages* pages) {
+  if (!pages) return;
+  for (int i = 0; i < pages->page_count; ++i) SDL_DestroyTexture(pages->pages[i]);
+  free(pages->slots);
+  free(pages->pending);
+  free(pages->staging);
+  free(pages->tile_slots);
+  free(pages);
+}
+/**
+ *  Setup the atlas pages for tiles enlarged `scale` times with `filter`.
+ *
+ *  Pages are sized to hold the whole tileset if the renderer allows it.
+ *  Larger tilesets get more pages, tiles are only uploaded when they're first drawn.
+ *
+ *  On failure `atlas->pages` is left as NULL.
+ */
+static int prepare_sdl2_atlas(struct TCOD_TilesetAtlasSDL2* atlas, int scale, TCOD_ScaleFilter filter) {
+  const struct TCOD_Tileset* tileset = atlas->tileset;
+  SDL_RendererInfo info;
+  int max_size = TCOD_SDL2_ATLAS_MAX_PAGE_SIZE;
+  if (SDL_GetRendererInfo(atlas->renderer, &info) == 0 && info.max_texture_width > 0 && info.max_texture_height > 0) {
+    max_size = MIN(max_size, MIN(info.max_texture_width, info.max_texture_height));
+  }
+  const int tile_width = MAX(tileset->tile_width * scale, 1);  // Avoid division by zero.
+  const int tile_height = MAX(tileset->tile_height * scale, 1);
+  int size = TCOD_SDL2_ATLAS_MIN_PAGE_SIZE;
+  while (size < max_size && (size / tile_width) * (size / tile_height) <= tileset->tiles_capacity) {
+    size *= 2;  // Grow until all tiles fit with one more slot for the white tile.
+  }
+  size = MIN(size, max_size);
+  if ((size / tile_width) * (size / tile_height) < 2) {
+    return TCOD_set_errorvf(
+        "Tiles of %ix%i are too large for the renderers max texture size of %i.",
+        tileset->tile_width * scale,
+        tileset->tile_height * scale,
+        max_size);
+  }
+  AtlasPages* pages = calloc(1, sizeof(*pages));
+  if (!pages) {
+    TCOD_set_errorv("Out of memory.");
+    return TCOD_E_OUT_OF_MEMORY;
+  }
+  atlas->pages = pages;
+  pages->scale = scale;
+  pages->filter = filter;
+  pages->tile_width = tileset->tile_width * scale;
+  pages->tile_height = tileset->tile_height * scale;
+  pages->page_size = size;
+  pages->columns = size / tile_width;
+  pages->slots_per_page = pages->columns * (size / tile_height);
+  pages->lru_head = pages->lru_tail = -1;
+  pages->frame = 1;
+  atlas->texture_columns = pages->columns;
+  const int err = add_sdl2_atlas_page(atlas);
+  if (err < 0) {
+    delete_sdl2_atlas_pages(pages);
+    atlas->pages = NULL;
+    atlas->texture = NULL;
   }
-  int new_size = current_size ? current_size : 256;
-  int columns = 1;  // Must be more than zero.
-  int rows = 1;
+  return err;
+}
+/// Remove `slot` from the recently used list.
+static void lru_unlink(AtlasPages* __restrict pages, int slot) {
+  AtlasSlot* it = &pages->slots[slot];
+  if (it->prev >= 0) pages->slots[it->prev].next = it->next;
+  if (it->next >= 0) pages->slots[it->next].prev = it->prev;
+  if (pages->lru_head == slot) pages->lru_head = it->next;
+  if (pages->lru_tail == slot) pages->lru_tail = it->prev;
+  it->prev = it->next = -1;
+}
+/// Add `slot` as the most recently used slot.
+static void lru_push_front(AtlasPages* __restrict pages, int slot) {
+  AtlasSlot* it = &pages->slots[slot];
+  it->prev = -1;
+  it->next = pages->lru_head;
+  if (pages->lru_head >= 0) pages->slots[pages->lru_head].prev = slot;
+  pages->lru_head = slot;
+  if (pages->lru_tail < 0) pages->lru_tail = slot;
+  it->frame = pages->frame;
+}
+/**
+ *  Return a slot which can be assigned a new tile, or a negative value on error.
+ *
+ *  Unused slots are handed out first, then new pages are added, then the least recently used tile is evicted.
+ */
+static int new_sdl2_atlas_slot(const struct TCOD_TilesetAtlasSDL2* __restrict atlas) {
+  AtlasPages* pages = atlas->pages;
   while (1) {
-    if (atlas->tileset->tile_width == 0 || atlas->tileset->tile_height == 0) {
-      break;  // Avoid division by zero.
+    while (pages->slots_used < pages->page_count * pages->slots_per_page) {
+      const int slot = pages->slots_used++;
+      if (slot % pages->slots_per_page == pages->slots_per_page - 1) continue;  // White tile.
+      pages->slots[slot] = (AtlasSlot){-1, -1, -1, 0};
+      return slot;
     }
-    columns = new_size / atlas->tileset->tile_width;
-    rows = new_size / atlas->tileset->tile_height;
-    if (rows * columns >= atlas->tileset->tiles_capacity) {
-      break;
-    }
-    new_size *= 2;
+    if (pages->page_count == TCOD_SDL2_ATLAS_MAX_PAGES) break;
+    const int err = add_sdl2_atlas_page((struct TCOD_TilesetAtlasSDL2*)atlas);
+    if (err < 0) return err;
   }
-  if (new_size != current_size) {
-    if (atlas->texture) {
-      SDL_DestroyTexture(atlas->texture);
-    }
-    atlas->texture =
-        SDL_CreateTexture(atlas->renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, new_size, new_size);
-    if (!atlas->texture) {
-      return -1;
+  const int slot = pages->lru_tail;
+  if (slot < 0) return TCOD_set_errorv("Atlas has no slots to evict.");
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+  if (pages->slots[slot].frame == pages->frame) {
+    vertex_buffer_flush(atlas->vertex_buffer, atlas);  // Draw any quads still using the evicted tile.
+  }
+#endif  // SDL_VERSION_ATLEAST(2, 0, 18)
+  lru_unlink(pages, slot);
+  pages->tile_slots[pages->slots[slot].tile_id] = -1;
+  pages->slots[slot].tile_id = -1;
+  return slot;
+}
+/// Return true if a new tile can be made resident without evicting a tile drawn by the current render.
+static bool sdl2_atlas_can_assign(const AtlasPages* __restrict pages) {
+  if (pages->page_count < TCOD_SDL2_ATLAS_MAX_PAGES) return true;
+  if (pages->slots_used < pages->page_count * pages->slots_per_page - 1) return true;  // The last slot is white.
+  return pages->lru_tail >= 0 && pages->slots[pages->lru_tail].frame != pages->frame;
+}
+/**
+ *  Upload every pending slot.
+ *
+ *  Pending slots are sorted and grouped into rectangles spanning runs of nearby rows on the same page.
+ *  Each rectangle is filled from the tileset and uploaded with one SDL_UpdateTexture call.
+ */
+static int upload_sdl2_atlas_pending(const struct TCOD_TilesetAtlasSDL2* __restrict atlas) {
+  AtlasPages* pages = atlas->pages;
+  qsort(pages->pending, pages->pending_length, sizeof(*pages->pending), compare_int_);
+  int err = 0;
+  for (int i = 0; i < pages->pending_length;) {
+    const int page = pages->pending[i] / pages->slots_per_page;
+    const int row_begin = (pages->pending[i] % pages->slots_per_page) / pages->columns;
+    int row_end = row_begin + 1;
+    int column_begin = pages->columns;
+    int column_end = 0;
+    for (; i < pages->pending_length && pages->pending[i] / pages->slots_per_page == page; ++i) {
+      const int index = pages->pending[i] % pages->slots_per_page;
+      if (index / pages->columns > row_end) break;  // Don't upload more than one clean row between dirty rows.
+      row_end = index / pages->columns + 1;
+      column_begin = MIN(column_begin, index % pages->columns);
+      column_end = MAX(column_end, index % pages->columns + 1);
     }
-    atlas->texture_columns = columns;
-    for (int i = 0; i < atlas->tileset->tiles_count; ++i) {
-      if (update_sdl2_tile(atlas, i) < 0) {
-        return -1;  // Issue with SDL_UpdateTexture.
+    const int rect_columns = column_end - column_begin;
+    const int rect_width = rect_columns * pages->tile_width;
+    const int rect_length = rect_width * (row_end - row_begin) * pages->tile_height;
+    err = reserve_sdl2_atlas_staging(pages, rect_length);
+    if (err < 0) break;
+    // Copy every tile in the rectangle, not just the pending ones, since the whole rectangle is replaced.
+    for (int row = row_begin; row < row_end; ++row) {
+      for (int column = column_begin; column < column_end; ++column) {
+        const int index = row * pages->columns + column;
+        const int slot = page * pages->slots_per_page + index;
+        int tile_id = -1;  // White tile.
+        if (index != pages->slots_per_page - 1) {
+          if (slot >= pages->slots_used || pages->slots[slot].tile_id < 0) continue;  // Unassigned, never sampled.
+          tile_id = pages->slots[slot].tile_id;
+        }
+        TCOD_ColorRGBA* out = pages->staging + (row - row_begin) * pages->tile_height * rect_width +
+                              (column - column_begin) * pages->tile_width;
+        write_sdl2_atlas_tile(atlas, tile_id, out, rect_width);
       }
     }
-    return 1;  // Atlas texture has been resized and refreshed.
+    const SDL_Rect dest = {
+        column_begin * pages->tile_width,
+        row_begin * pages->tile_height,
+        rect_width,
+        (row_end - row_begin) * pages->tile_height,
+    };
+    if (SDL_UpdateTexture(pages->pages[page], &dest, pages->staging, rect_width * (int)sizeof(*pages->staging)) < 0) {
+      err = TCOD_set_errorvf("SDL error: %s", SDL_GetError());
+    }
   }
-  return 0;  // No action.
+  pages->pending_length = 0;
+  return err;
+}
+/**
+ *  Return the slot holding `tile_id`, assigning a slot if the tile isn't resident.
+ *
+ *  New tiles are uploaded immediately unless `defer_upload` is true, in which case they're added to the pending list.
+ *
+ *  Returns a negative value on error.
+ */
+static int get_sdl2_atlas_tile_slot(
+    const struct TCOD_TilesetAtlasSDL2* __restrict atlas, int tile_id, bool defer_upload) {
+  AtlasPages* pages = atlas->pages;
+  if (tile_id >= pages->tile_slots_length) {
+    const int new_length = MAX(atlas->tileset->tiles_capacity, tile_id + 1);
+    int* new_tile_slots = realloc(pages->tile_slots, sizeof(*new_tile_slots) * new_length);
+    if (!new_tile_slots) {
+      TCOD_set_errorv("Out of memory.");
+      return TCOD_E_OUT_OF_MEMORY;
+    }
+    for (int i = pages->tile_slots_length; i < new_length; ++i) new_tile_slots[i] = -1;
+    pages->tile_slots = new_tile_slots;
+    pages->tile_slots_length = new_length;
+  }
+  int slot = pages->tile_slots[tile_id];
+  if (slot >= 0) {
+    if (pages->slots[slot].frame != pages->frame) {
+      lru_unlink(pages, slot);
+      lru_push_front(pages, slot);
+    }
+    return slot;
+  }
+  slot = new_sdl2_atlas_slot(atlas);
+  if (slot < 0) return slot;
+  pages->slots[slot].tile_id = tile_id;
+  pages->tile_slots[tile_id] = slot;
+  lru_push_front(pages, slot);
+  if (defer_upload) {
+    pages->pending[pages->pending_length++] = slot;
+    return slot;
+  }
+  if (update_sdl2_slot(atlas, slot) < 0) return TCOD_set_errorvf("SDL error: %s", SDL_GetError());
+  return slot;
 }
 /**
  *  Respond to changes in a tileset.
+ *
+ *  Only resident tiles are uploaded, other tiles are uploaded when they're next drawn.
  */
 static int sdl2_atlas_on_tile_changed(struct TCOD_TilesetObserver* observer, int tile_id) {
-  struct TCOD_TilesetAtlasSDL2* atlas = observer->userdata;
-  if (prepare_sdl2_atlas(atlas) == 1) {
-    return 0;  // Tile updated as a side-effect of prepare_sdl2_atlas.
-  }
-  return update_sdl2_tile(atlas, tile_id);
+  const struct TCOD_TilesetAtlasSDL2* atlas = observer->userdata;
+  if (tile_id >= atlas->pages->tile_slots_length || atlas->pages->tile_slots[tile_id] < 0) return 0;
+  return update_sdl2_slot(atlas, atlas->pages->tile_slots[tile_id]);
+}
+/**
+ *  Respond to a batch of changes in a tileset by uploading the resident tiles together.
+ */
+static int sdl2_atlas_on_tiles_changed(struct TCOD_TilesetObserver* observer, const int* tile_ids, int count) {
+  const struct TCOD_TilesetAtlasSDL2* atlas = observer->userdata;
+  AtlasPages* pages = atlas->pages;
+  for (int i = 0; i < count; ++i) {
+    if (tile_ids[i] >= pages->tile_slots_length || pages->tile_slots[tile_ids[i]] < 0) continue;
+    pages->pending[pages->pending_length++] = pages->tile_slots[tile_ids[i]];
+  }
+  return upload_sdl2_atlas_pending(atlas);
 }
 struct TCOD_TilesetAtlasSDL2* TCOD_sdl2_atlas_new(struct SDL_Renderer* renderer, struct TCOD_Tileset* tileset) {
   if (!renderer || !tileset) {
@@ -160,7 +508,19 @@ struct TCOD_TilesetAtlasSDL2* TCOD_sdl2_atlas_new(struct SDL_Renderer* renderer,
   atlas->tileset->ref_count += 1;
   atlas->observer->userdata = atlas;
   atlas->observer->on_tile_changed = sdl2_atlas_on_tile_changed;
-  prepare_sdl2_atlas(atlas);
+  atlas->observer->on_tiles_changed = sdl2_atlas_on_tiles_changed;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+  atlas->vertex_buffer = vertex_buffer_new();
+  if (!atlas->vertex_buffer) {
+    TCOD_set_errorv("Out of memory.");
+    TCOD_sdl2_atlas_delete(atlas);
+    return NULL;
+  }
+#endif  // SDL_VERSION_ATLEAST(2, 0, 18)
+  if (prepare_sdl2_atlas(atlas, 1, TCOD_SCALE_FILTER_NEAREST) < 0) {
+    TCOD_sdl2_atlas_delete(atlas);
+    return NULL;
+  }
   return atlas;
 }
 void TCOD_sdl2_atlas_delete(struct TCOD_TilesetAtlasSDL2* atlas) {
@@ -173,31 +533,63 @@ void TCOD_sdl2_atlas_delete(struct TCOD_TilesetAtlasSDL2* atlas) {
   if (atlas->tileset) {
     TCOD_tileset_delete(atlas->tileset);
   }
-  if (atlas->texture) {
-    SDL_DestroyTexture(atlas->texture);
-  }
+  delete_sdl2_atlas_pages(atlas->pages);
+  free(atlas->vertex_buffer);
   free(atlas);
 }
+TCOD_Error TCOD_sdl2_atlas_set_scale(struct TCOD_TilesetAtlasSDL2* atlas, int scale, TCOD_ScaleFilter filter) {
+  if (!atlas || !atlas->pages) {
+    TCOD_set_errorv("Atlas must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (scale < 1) {
+    TCOD_set_errorvf("Scale must be at least 1, got %i.", scale);
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (scale == 1) {
+    filter = TCOD_SCALE_FILTER_NEAREST;  // Tiles are copied as they are.
+  } else if (filter != TCOD_SCALE_FILTER_NEAREST && filter != TCOD_SCALE_FILTER_LINEAR) {
+    TCOD_set_errorvf("Invalid scale filter %i.", (int)filter);
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (atlas->pages->scale == scale && atlas->pages->filter == filter) return TCOD_E_OK;
+  AtlasPages* old_pages = atlas->pages;
+  SDL_Texture* old_texture = atlas->texture;
+  if (prepare_sdl2_atlas(atlas, scale, filter) < 0) {
+    atlas->pages = old_pages;  // Keep the atlas usable at its old scale.
+    atlas->texture = old_texture;
+    atlas->texture_columns = old_pages->columns;
+    return TCOD_E_ERROR;
+  }
+  delete_sdl2_atlas_pages(old_pages);
+  return TCOD_E_OK;
+}
 /**
- *  Update a cache console by resetting tiles which point to the updated tile.
+ *  Update a cache console by resetting tiles which point to any of the sorted `tile_ids[count]`.
  */
-static int cache_console_update(struct TCOD_TilesetObserver* observer, int tile_id) {
+static int cache_console_update_tiles(struct TCOD_TilesetObserver* observer, const int* tile_ids, int count) {
   struct TCOD_Console* console = observer->userdata;
-  for (int c = 0; c < observer->tileset->character_map_length; ++c) {
-    // Find codepoints that point to the tile_id.
-    if (observer->tileset->character_map[c] != tile_id) {
+  const struct TCOD_Tileset* tileset = observer->tileset;
+  for (int i = 0; i < console->elements; ++i) {
+    const int ch = console->tiles[i].ch;
+    if (ch < 0 || ch >= tileset->character_map_length) {
       continue;
     }
-    for (int i = 0; i < console->elements; ++i) {
-      // Compare matched codepoints to the cache console characters.
-      if (console->tiles[i].ch != c) {
-        continue;
-      }
-      console->tiles[i].ch = -1;
+    const int tile_id = TCOD_tileset_get_tile_id_(tileset, ch);
+    if (!bsearch(&tile_id, tile_ids, count, sizeof(*tile_ids), compare_int_)) {
+      continue;
     }
+    console->tiles[i].ch = -1;
+    TCOD_console_mark_dirty(console, i % console->w, i / console->w, 1, 1);
   }
   return 0;
 }
+/**
+ *  Update a cache console by resetting tiles which point to the updated tile.
+ */
+static int cache_console_update(struct TCOD_TilesetObserver* observer, int tile_id) {
+  return cache_console_update_tiles(observer, &tile_id, 1);
+}
 /**
  *  Delete a consoles observer if it exists.
  */
@@ -251,11 +643,14 @@ static TCOD_Error setup_cache_console(
     observer->userdata = *cache;
     (*cache)->userdata = observer;
     observer->on_tile_changed = cache_console_update;
+    observer->on_tiles_changed = cache_console_update_tiles;
     (*cache)->on_delete = cache_console_on_delete;
     observer->on_observer_delete = cache_console_observer_delete;
     for (int i = 0; i < (*cache)->elements; ++i) {
       (*cache)->tiles[i].ch = -1;
     }
+    // Lets the renderer skip rows which were not written to.  Without it every tile is compared instead.
+    (void)TCOD_console_set_write_tracking(*cache, true);
   }
   return TCOD_E_OK;
 }
@@ -265,7 +660,7 @@ TCOD_ConsoleTile normalize_tile_for_drawing(TCOD_ConsoleTile tile, const TCOD_Ti
   if (tile.ch == 0x20) tile.ch = 0;  // Tile is the space character.
   if (tile.ch < 0 || tile.ch >= tileset->character_map_length) {
     tile.ch = 0;  // Tile character is out-of-bounds.
-  } else if (tileset->character_map[tile.ch] == 0) {
+  } else if (TCOD_tileset_get_tile_id_(tileset, tile.ch) == 0) {
     tile.ch = 0;  // Ignore characters not defined in the tileset.
   }
   if (tile.fg.a == 0) tile.ch = 0;  // No foreground alpha.
@@ -278,44 +673,46 @@ TCOD_ConsoleTile normalize_tile_for_drawing(TCOD_ConsoleTile tile, const TCOD_Ti
   }
   return tile;
 }
-#if SDL_VERSION_ATLEAST(2, 0, 18)
-/// Initialize indices up to the current buffer index.
-static void vertex_buffer_sync_indices(VertexBuffer* __restrict buffer) {
-  for (; buffer->indices_initialized < buffer->index; ++buffer->indices_initialized) {
-    buffer->indices[buffer->indices_initialized * 6 + 0] = buffer->indices_initialized * 4;
-    buffer->indices[buffer->indices_initialized * 6 + 1] = buffer->indices_initialized * 4 + 1;
-    buffer->indices[buffer->indices_initialized * 6 + 2] = buffer->indices_initialized * 4 + 2;
-    buffer->indices[buffer->indices_initialized * 6 + 3] = buffer->indices_initialized * 4 + 2;
-    buffer->indices[buffer->indices_initialized * 6 + 4] = buffer->indices_initialized * 4 + 1;
-    buffer->indices[buffer->indices_initialized * 6 + 5] = buffer->indices_initialized * 4 + 3;
-  }
-}
-/// Draw all background elements and clear the buffer.
-static void vertex_buffer_flush_bg(VertexBuffer* __restrict buffer, const TCOD_TilesetAtlasSDL2* __restrict atlas) {
-  vertex_buffer_sync_indices(buffer);
-  SDL_SetRenderDrawBlendMode(atlas->renderer, SDL_BLENDMODE_NONE);
-  SDL_RenderGeometryRaw(
-      atlas->renderer,
-      NULL,  // No texture, this renders solid colors.
-      &buffer->vertex->x,
-      sizeof(*buffer->vertex),
-      (SDL_Color*)&buffer->vertex->rgba,
-      sizeof(*buffer->vertex),
-      NULL,
-      0,
-      buffer->index * 4,
-      buffer->indices,
-      buffer->index * 6,
-      2);
-  buffer->index = 0;
+/**
+ *  Make the glyphs drawn by the next render resident, uploading the new ones together.
+ *
+ *  Stops early if the atlas would have to evict a glyph this render needs, the remaining glyphs are uploaded one at a
+ *  time while drawing.
+ */
+static int prefetch_sdl2_atlas_tiles(
+    const TCOD_TilesetAtlasSDL2* __restrict atlas,
+    const TCOD_Console* __restrict console,
+    const TCOD_Console* __restrict cache) {
+  for (int y = 0; y < console->h && sdl2_atlas_can_assign(atlas->pages); ++y) {
+    const TCOD_ConsoleDirtySpan span = TCOD_console_get_redraw_span_(console, cache, y);
+    for (int x = span.begin; x < span.end; ++x) {
+      const TCOD_ConsoleTile tile = normalize_tile_for_drawing(console->tiles[console->w * y + x], atlas->tileset);
+      if (tile.ch == 0) continue;
+      if (cache) {
+        const TCOD_ConsoleTile cached = cache->tiles[cache->w * y + x];
+        if (tile.ch == cached.ch && tile.fg.r == cached.fg.r && tile.fg.g == cached.fg.g && tile.fg.b == cached.fg.b &&
+            tile.fg.a == cached.fg.a && tile.bg.r == cached.bg.r && tile.bg.g == cached.bg.g &&
+            tile.bg.b == cached.bg.b && tile.bg.a == cached.bg.a) {
+          continue;  // Won't be drawn.
+        }
+      }
+      const int tile_id = TCOD_tileset_get_tile_id_(atlas->tileset, tile.ch);
+      if (tile_id >= atlas->pages->tile_slots_length || atlas->pages->tile_slots[tile_id] < 0) {
+        if (!sdl2_atlas_can_assign(atlas->pages)) break;
+      }
+      const int slot = get_sdl2_atlas_tile_slot(atlas, tile_id, true);
+      if (slot < 0) return slot;
+    }
+  }
+  return upload_sdl2_atlas_pending(atlas);
 }
-/// Draw all foreground elements and clear the buffer.
-static void vertex_buffer_flush_fg(VertexBuffer* __restrict buffer, const TCOD_TilesetAtlasSDL2* __restrict atlas) {
-  vertex_buffer_sync_indices(buffer);
-  SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+/// Draw all buffered elements and clear the buffer.
+static void vertex_buffer_flush(VertexBuffer* __restrict buffer, const TCOD_TilesetAtlasSDL2* __restrict atlas) {
+  if (buffer->index == 0) return;
   SDL_RenderGeometryRaw(
       atlas->renderer,
-      atlas->texture,
+      atlas->pages->pages[buffer->page],
       &buffer->vertex->x,
       sizeof(*buffer->vertex),
       (SDL_Color*)&buffer->vertex->rgba,
@@ -330,15 +727,17 @@ static void vertex_buffer_flush_fg(VertexBuffer* __restrict buffer, const TCOD_T
 }
 /// Set the vertices of a tile position.
 static void vertex_buffer_set_tile_pos(
-    VertexBuffer* __restrict buffer, int index, int x, int y, const TCOD_Tileset* __restrict tileset) {
-  buffer->vertex[index * 4 + 0].x = (float)(x * tileset->tile_width);
-  buffer->vertex[index * 4 + 0].y = (float)(y * tileset->tile_height);
-  buffer->vertex[index * 4 + 1].x = (float)(x * tileset->tile_width);
-  buffer->vertex[index * 4 + 1].y = (float)((y + 1) * tileset->tile_height);
-  buffer->vertex[index * 4 + 2].x = (float)((x + 1) * tileset->tile_width);
-  buffer->vertex[index * 4 + 2].y = (float)(y * tileset->tile_height);
-  buffer->vertex[index * 4 + 3].x = (float)((x + 1) * tileset->tile_width);
-  buffer->vertex[index * 4 + 3].y = (float)((y + 1) * tileset->tile_height);
+    VertexBuffer* __restrict buffer, int index, int x, int y, const TCOD_TilesetAtlasSDL2* __restrict atlas) {
+  const int tile_width = atlas->pages->tile_width;
+  const int tile_height = atlas->pages->tile_height;
+  buffer->vertex[index * 4 + 0].x = (float)(x * tile_width);
+  buffer->vertex[index * 4 + 0].y = (float)(y * tile_height);
+  buffer->vertex[index * 4 + 1].x = (float)(x * tile_width);
+  buffer->vertex[index * 4 + 1].y = (float)((y + 1) * tile_height);
+  buffer->vertex[index * 4 + 2].x = (float)((x + 1) * tile_width);
+  buffer->vertex[index * 4 + 2].y = (float)(y * tile_height);
+  buffer->vertex[index * 4 + 3].x = (float)((x + 1) * tile_width);
+  buffer->vertex[index * 4 + 3].y = (float)((y + 1) * tile_height);
 }
 /// Set the colors of a tile.
 static void vertex_buffer_set_color(VertexBuffer* __restrict buffer, int index, TCOD_ColorRGBA rgba) {
@@ -348,32 +747,44 @@ static void vertex_buffer_set_color(VertexBuffer* __restrict buffer, int index,
   buffer->vertex[index * 4 + 3].rgba = rgba;
 }
 /// Push a background element onto the buffer, flushing it if needed.
+/// All corners sample the center of the white tile so that filtering can't pick up neighboring glyphs.
 static void vertex_buffer_push_bg(
     VertexBuffer* __restrict buffer,
     int x,
     int y,
     TCOD_ConsoleTile tile,
-    const TCOD_TilesetAtlasSDL2* __restrict atlas) {
-  if (buffer->index == BUFFER_TILES_MAX) vertex_buffer_flush_bg(buffer, atlas);
-  vertex_buffer_set_tile_pos(buffer, buffer->index, x, y, atlas->tileset);
+    const TCOD_TilesetAtlasSDL2* __restrict atlas,
+    VertexUV white_uv) {
+  if (buffer->index == BUFFER_TILES_MAX) vertex_buffer_flush(buffer, atlas);
+  vertex_buffer_set_tile_pos(buffer, buffer->index, x, y, atlas);
   vertex_buffer_set_color(buffer, buffer->index, tile.bg);
+  buffer->vertex_uv[buffer->index * 4 + 0] = white_uv;
+  buffer->vertex_uv[buffer->index * 4 + 1] = white_uv;
+  buffer->vertex_uv[buffer->index * 4 + 2] = white_uv;
+  buffer->vertex_uv[buffer->index * 4 + 3] = white_uv;
   ++buffer->index;
 }
-/// Push a foreground element onto the buffer, flushing it if needed.
+/// Push a foreground element for the glyph at atlas `slot` onto the buffer.
+/// The buffer is flushed if it's full or if `slot` is on a different page than the buffered quads.
 static void vertex_buffer_push_fg(
     VertexBuffer* __restrict buffer,
     int x,
     int y,
     TCOD_ConsoleTile tile,
     const TCOD_TilesetAtlasSDL2* __restrict atlas,
+    int slot,
     float u_multiply,
     float v_multiply) {
-  if (buffer->index == BUFFER_TILES_MAX) vertex_buffer_flush_fg(buffer, atlas);
-  vertex_buffer_set_tile_pos(buffer, buffer->index, x, y, atlas->tileset);
+  const int page = slot / atlas->pages->slots_per_page;
+  if (page != buffer->page) {
+    vertex_buffer_flush(buffer, atlas);
+    buffer->page = page;
+  }
+  if (buffer->index == BUFFER_TILES_MAX) vertex_buffer_flush(buffer, atlas);
+  vertex_buffer_set_tile_pos(buffer, buffer->index, x, y, atlas);
   vertex_buffer_set_color(buffer, buffer->index, tile.fg);
   // Used a lazy method of UV assignment.  This could be improved to use fewer math operations.
-  const int tile_id = atlas->tileset->character_map[tile.ch];
-  const SDL_Rect src = get_sdl2_atlas_tile(atlas, tile_id);
+  const SDL_Rect src = get_sdl2_atlas_slot(atlas, slot);
   buffer->vertex_uv[buffer->index * 4 + 0].u = (float)(src.x) * u_multiply;
   buffer->vertex_uv[buffer->index * 4 + 0].v = (float)(src.y) * v_multiply;
   buffer->vertex_uv[buffer->index * 4 + 1].u = (float)(src.x) * u_multiply;
@@ -413,71 +824,65 @@ static TCOD_Error TCOD_sdl2_render(
     TCOD_set_errorv("Cache console must match the size of the input console.");
     return TCOD_E_INVALID_ARGUMENT;
   }
+  ++atlas->pages->frame;  // Glyphs drawn by this render won't be evicted unless every atlas slot is in use.
+  const int prefetch_err = prefetch_sdl2_atlas_tiles(atlas, console, cache);
+  if (prefetch_err < 0) return (TCOD_Error)prefetch_err;
 #if SDL_VERSION_ATLEAST(2, 0, 18)
-  // Allocate a buffer on the stack and initialize only a few variables.
-  // Reused for the background and foreground passes.
-  VertexBuffer* buffer = malloc(sizeof(*buffer));
-  if (!buffer) return TCOD_E_OUT_OF_MEMORY;
+  // The atlas owns this buffer and it is reused across renders.
+  VertexBuffer* buffer = atlas->vertex_buffer;
+  if (!buffer) {
+    TCOD_set_errorv("Atlas must be created with TCOD_sdl2_atlas_new.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
   buffer->index = 0;
-  buffer->indices_initialized = 0;
+  buffer->page = 0;
+  // Used to transform texture pixel coordinates to UV coords.  All pages are the same size.
+  const float u_multiply = 1.0f / (float)(atlas->pages->page_size);
+  const float v_multiply = 1.0f / (float)(atlas->pages->page_size);
+  // Every page has its white tile in the same place, so backgrounds can be batched with any page.
+  const SDL_Rect white_tile = get_sdl2_atlas_slot(atlas, atlas->pages->slots_per_page - 1);
+  const VertexUV white_uv = {
+      ((float)white_tile.x + (float)white_tile.w * 0.5f) * u_multiply,
+      ((float)white_tile.y + (float)white_tile.h * 0.5f) * v_multiply,
+  };
+  // Background and foreground quads are interleaved per tile and submitted together with their atlas page.
   for (int y = 0; y < console->h; ++y) {
-    for (int x = 0; x < console->w; ++x) {
+    // Only the columns written to since the last render need to be checked, this is the whole row without tracking.
+    const TCOD_ConsoleDirtySpan span = TCOD_console_get_redraw_span_(console, cache, y);
+    for (int x = span.begin; x < span.end; ++x) {
       const TCOD_ConsoleTile tile = normalize_tile_for_drawing(console->tiles[console->w * y + x], atlas->tileset);
       if (cache) {
         TCOD_ConsoleTile* cached = &cache->tiles[cache->w * y + x];
-        // True if there are changes to the BG color.
-        const bool bg_changed = tile.bg.r != cached->bg.r || tile.bg.g != cached->bg.g || tile.bg.b != cached->bg.b ||
-                                tile.bg.a != cached->bg.a;
-        // True if there are changes to the FG glyph.
-        const bool fg_changed =
-            cached->ch && (tile.ch != cached->ch || tile.fg.r != cached->fg.r || tile.fg.g != cached->fg.g ||
-                           tile.fg.b != cached->fg.b || tile.fg.a != cached->fg.a);
-        if (!(bg_changed || fg_changed)) {
+        if (tile.ch == cached->ch && tile.fg.r == cached->fg.r && tile.fg.g == cached->fg.g &&
+            tile.fg.b == cached->fg.b && tile.fg.a == cached->fg.a && tile.bg.r == cached->bg.r &&
+            tile.bg.g == cached->bg.g && tile.bg.b == cached->bg.b && tile.bg.a == cached->bg.a) {
           continue;  // If no changes exist then this tile can be skipped entirely.
         }
-        // Cache the BG and unset the FG data, this will tell the FG pass if it needs to draw the glyph.
-        *cached = (TCOD_ConsoleTile){0, {0, 0, 0, 0}, tile.bg};
+        *cached = tile;
       }
-      // Data is pushed onto the buffer, this is flushed automatically if it would otherwise overflow.
-      vertex_buffer_push_bg(buffer, x, y, tile, atlas);
-    }
-  }
-  // Flush any remaining data.  The buffer can now be reused for foreground data.
-  vertex_buffer_flush_bg(buffer, atlas);
-
-  // The foreground rendering pass.  Draw FG glyphs on top of the background tiles.
-  int tex_width;
-  int tex_height;
-  SDL_QueryTexture(atlas->texture, NULL, NULL, &tex_width, &tex_height);
-  const float u_multiply = 1.0f / (float)(tex_width);  // Used to transform texture pixel coordinates to UV coords.
-  const float v_multiply = 1.0f / (float)(tex_height);
-  for (int y = 0; y < console->h; ++y) {
-    for (int x = 0; x < console->w; ++x) {
-      const TCOD_ConsoleTile tile = normalize_tile_for_drawing(console->tiles[console->w * y + x], atlas->tileset);
-      if (tile.ch == 0) continue;  // No FG glyph to draw.
-      if (cache) {
-        TCOD_ConsoleTile* cached = &cache->tiles[cache->w * y + x];
-        // cached->ch will be set to zero by the background pass on changes to the foreground color or glyph.
-        // Because of this the FG color does not need to be checked here.
-        if (tile.ch == cached->ch) {
-          continue;  // The glyph has not changed since the last render.
-        }
-        // Cache the foreground glyph.
-        cached->ch = tile.ch;
-        cached->fg = tile.fg;
+      if (tile.bg.a == 255) {
+        vertex_buffer_push_bg(buffer, x, y, tile, atlas, white_uv);
+      } else {
+        // Translucent backgrounds replace the old pixels instead of blending with them, this can't be batched.
+        vertex_buffer_flush(buffer, atlas);
+        const SDL_Rect dest = get_aligned_tile(atlas, x, y);
+        SDL_SetRenderDrawBlendMode(atlas->renderer, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(atlas->renderer, tile.bg.r, tile.bg.g, tile.bg.b, tile.bg.a);
+        SDL_RenderFillRect(atlas->renderer, &dest);
       }
-      vertex_buffer_push_fg(buffer, x, y, tile, atlas, u_multiply, v_multiply);
+      if (tile.ch == 0) continue;
+      const int slot = get_sdl2_atlas_tile_slot(atlas, TCOD_tileset_get_tile_id_(atlas->tileset, tile.ch), false);
+      if (slot < 0) return (TCOD_Error)slot;
+      vertex_buffer_push_fg(buffer, x, y, tile, atlas, slot, u_multiply, v_multiply);
     }
   }
-  vertex_buffer_flush_fg(buffer, atlas);
-  free(buffer);
+  vertex_buffer_flush(buffer, atlas);
 #else  // SDL VERSION < 2.0.18
   SDL_SetRenderDrawBlendMode(atlas->renderer, SDL_BLENDMODE_NONE);
-  SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
-  SDL_SetTextureAlphaMod(atlas->texture, 0xff);
   for (int y = 0; y < console->h; ++y) {
-    for (int x = 0; x < console->w; ++x) {
-      const SDL_Rect dest = get_aligned_tile(atlas->tileset, x, y);
+    const TCOD_ConsoleDirtySpan span = TCOD_console_get_redraw_span_(console, cache, y);
+    for (int x = span.begin; x < span.end; ++x) {
+      const SDL_Rect dest = get_aligned_tile(atlas, x, y);
       const TCOD_ConsoleTile tile = normalize_tile_for_drawing(console->tiles[console->w * y + x], atlas->tileset);
       if (cache) {
         const struct TCOD_ConsoleTile cached = cache->tiles[cache->w * y + x];
@@ -495,14 +900,17 @@ static TCOD_Error TCOD_sdl2_render(
         continue;  // Skip foreground glyph.
       }
       // Blend the foreground glyph on top of the background.
-      SDL_SetTextureColorMod(atlas->texture, tile.fg.r, tile.fg.g, tile.fg.b);
-      SDL_SetTextureAlphaMod(atlas->texture, tile.fg.a);
-      const int tile_id = atlas->tileset->character_map[tile.ch];
-      const SDL_Rect src = get_sdl2_atlas_tile(atlas, tile_id);
-      SDL_RenderCopy(atlas->renderer, atlas->texture, &src, &dest);
+      const int slot = get_sdl2_atlas_tile_slot(atlas, TCOD_tileset_get_tile_id_(atlas->tileset, tile.ch), false);
+      if (slot < 0) return (TCOD_Error)slot;
+      SDL_Texture* page = get_sdl2_atlas_page(atlas, slot);
+      SDL_SetTextureColorMod(page, tile.fg.r, tile.fg.g, tile.fg.b);
+      SDL_SetTextureAlphaMod(page, tile.fg.a);
+      const SDL_Rect src = get_sdl2_atlas_slot(atlas, slot);
+      SDL_RenderCopy(atlas->renderer, page, &src, &dest);
     }
   }
 #endif  // SDL_VERSION_ATLEAST
+  TCOD_console_end_redraw_(console, cache);
   return TCOD_E_OK;
 }
 TCOD_Error TCOD_sdl2_render_texture_setup(
@@ -534,8 +942,7 @@ TCOD_Error TCOD_sdl2_render_texture_setup(
     int tex_width;
     int tex_height;
     SDL_QueryTexture(*target, NULL, NULL, &tex_width, &tex_height);
-    if (tex_width != atlas->tileset->tile_width * console->w ||
-        tex_height != atlas->tileset->tile_height * console->h) {
+    if (tex_width != atlas->pages->tile_width * console->w || tex_height != atlas->pages->tile_height * console->h) {
       SDL_DestroyTexture(*target);
       *target = NULL;
       if (cache && *cache) {
@@ -550,8 +957,8 @@ TCOD_Error TCOD_sdl2_render_texture_setup(
         atlas->renderer,
         SDL_PIXELFORMAT_RGBA32,
         SDL_TEXTUREACCESS_TARGET,
-        atlas->tileset->tile_width * console->w,
-        atlas->tileset->tile_height * console->h);
+        atlas->pages->tile_width * console->w,
+        atlas->pages->tile_height * console->h);
     if (!*target) {
       return TCOD_set_errorv("Failed to create a new target texture.");
     }
@@ -567,6 +974,11 @@ TCOD_Error TCOD_sdl2_render_texture(
     const struct TCOD_Console* __restrict console,
     struct TCOD_Console* __restrict cache,
     struct SDL_Texture* __restrict target) {
+  if (atlas && console) {
+    // Load glyphs for lazy tilesets before the render target changes, the atlas is updated by its observer.
+    const TCOD_Error err = TCOD_tileset_request_console_tiles(atlas->tileset, console);
+    if (err < 0) return err;
+  }
   if (!target) {  // Render without a managed target.
     return TCOD_sdl2_render(atlas, console, cache);
   }
@@ -578,23 +990,22 @@ TCOD_Error TCOD_sdl2_render_texture(
 }
 // ----------------------------------------------------------------------------
 // SDL2 Rendering
+/// Counts SDL_RENDER_TARGETS_RESET events, this is written from whichever thread pushed the event.
+static SDL_atomic_t sdl2_targets_reset_count;
 /**
     Handle events from SDL2.
 
     Target textures need to be reset on an SDL_RENDER_TARGETS_RESET event.
 
-    This is sometimes called while the renderer is holding a reference to the
-    cache console.
+    This can be called from another thread or while the renderer is holding a
+    reference to the cache console, so the reset is only counted here and the
+    cache console is discarded by the next render.
  */
 static int sdl2_handle_event(void* userdata, SDL_Event* event) {
-  struct TCOD_RendererSDL2* context = userdata;
+  (void)userdata;
   switch (event->type) {
     case SDL_RENDER_TARGETS_RESET:
-      if (context->cache_console) {
-        for (int i = 0; i < context->cache_console->elements; ++i) {
-          context->cache_console->tiles[i] = (struct TCOD_ConsoleTile){-1, {0}, {0}};
-        }
-      }
+      SDL_AtomicAdd(&sdl2_targets_reset_count, 1);
       break;
   }
   return 0;
@@ -611,6 +1022,9 @@ static void sdl2_destructor(struct TCOD_Context* __restrict self) {
   if (context->cache_console) {
     TCOD_console_delete(context->cache_console);
   }
+  if (context->direct_console) {
+    TCOD_console_delete(context->direct_console);
+  }
   if (context->cache_texture) {
     SDL_DestroyTexture(context->cache_texture);
   }
@@ -680,6 +1094,53 @@ TCOD_NODISCARD static TCOD_RendererSDL2CursorTransform sdl2_cursor_transform_for
       (double)console->h / (double)dest.h,
   };
 }
+/**
+ *  Return the scale which `dest` enlarges `console` by if it can be drawn directly with pre-scaled tiles, otherwise 0.
+ *
+ *  At a scale of 1 the cache texture is copied without scaling and lets unchanged tiles be skipped, so it's kept.
+ */
+static int get_sdl2_direct_scale(
+    const struct TCOD_RendererSDL2* __restrict context, const struct TCOD_Console* __restrict console, SDL_Rect dest) {
+  if (context->scale_filter == TCOD_SCALE_FILTER_NONE || TCOD_ctx.sdl_cbk) return 0;
+  const int width = console->w * context->atlas->tileset->tile_width;
+  const int height = console->h * context->atlas->tileset->tile_height;
+  if (width <= 0 || height <= 0) return 0;
+  const int scale = dest.w / width;
+  if (scale < 2 || dest.w != width * scale || dest.h != height * scale) return 0;
+  return scale;
+}
+/**
+ *  Render `console` straight to `dest` on the current render target, with the atlas tiles enlarged `scale` times.
+ */
+static TCOD_Error sdl2_render_direct(
+    struct TCOD_RendererSDL2* __restrict context,
+    const struct TCOD_Console* __restrict console,
+    SDL_Rect dest,
+    int scale) {
+  TCOD_Error err = TCOD_sdl2_atlas_set_scale(context->atlas, scale, context->scale_filter);
+  if (err < 0) return err;
+  // The cache texture isn't drawn to, so keep a copy of the console for screen captures.
+  if (context->direct_console &&
+      (context->direct_console->w != console->w || context->direct_console->h != console->h)) {
+    TCOD_console_delete(context->direct_console);
+    context->direct_console = NULL;
+  }
+  if (!context->direct_console) {
+    context->direct_console = TCOD_console_new(console->w, console->h);
+    if (!context->direct_console) return TCOD_set_errorv("Failed to create an internal console.");
+  }
+  memcpy(context->direct_console->tiles, console->tiles, sizeof(*console->tiles) * console->elements);
+  if (context->cache_console) {
+    TCOD_console_delete(context->cache_console);  // The cache texture is out of date and must be redrawn if it's used.
+    context->cache_console = NULL;
+  }
+  SDL_Rect old_viewport;
+  SDL_RenderGetViewport(context->renderer, &old_viewport);
+  SDL_RenderSetViewport(context->renderer, &dest);
+  err = TCOD_sdl2_render_texture(context->atlas, console, NULL, NULL);
+  SDL_RenderSetViewport(context->renderer, &old_viewport);
+  return err;
+}
 /**
  *  Render to the SDL2 renderer without presenting the screen.
  */
@@ -691,7 +1152,29 @@ static TCOD_Error sdl2_accumulate(
   if (!context || !console) {
     return -1;
   }
-  TCOD_Error err;
+  const int targets_reset_count = SDL_AtomicGet(&sdl2_targets_reset_count);
+  if (context->targets_reset_count != targets_reset_count) {
+    context->targets_reset_count = targets_reset_count;
+    if (context->cache_console) {
+      TCOD_console_delete(context->cache_console);  // The cache texture was lost and must be fully redrawn.
+      context->cache_console = NULL;
+    }
+  }
+  SDL_Rect dest = get_destination_rect_for_console(context->atlas, console, viewport);
+  // Set mouse coordinate scaling.
+  context->cursor_transform = sdl2_cursor_transform_for_console_viewport(context->atlas, console, viewport);
+  const int direct_scale = get_sdl2_direct_scale(context, console, dest);
+  if (direct_scale) {
+    return sdl2_render_direct(context, console, dest, direct_scale);
+  }
+  if (context->direct_console) {
+    TCOD_console_delete(context->direct_console);
+    context->direct_console = NULL;
+  }
+  TCOD_Error err = TCOD_sdl2_atlas_set_scale(context->atlas, 1, TCOD_SCALE_FILTER_NEAREST);
+  if (err < 0) {
+    return err;
+  }
   err = TCOD_sdl2_render_texture_setup(context->atlas, console, &context->cache_console, &context->cache_texture);
   if (err < 0) {
     return err;
@@ -700,9 +1183,6 @@ static TCOD_Error sdl2_accumulate(
   if (err < 0) {
     return err;
   }
-  SDL_Rect dest = get_destination_rect_for_console(context->atlas, console, viewport);
-  // Set mouse coordinate scaling.
-  context->cursor_transform = sdl2_cursor_transform_for_console_viewport(context->atlas, console, viewport);
   if (!TCOD_ctx.sdl_cbk) {
     // Normal rendering.
     SDL_RenderCopy(context->renderer, context->cache_texture, NULL, &dest);
@@ -767,6 +1247,14 @@ static TCOD_Error sdl2_screen_capture(
     int* __restrict width,
     int* __restrict height) {
   struct TCOD_RendererSDL2* context = self->contextdata_;
+  if (context->direct_console) {
+    // The last frame skipped the cache texture, render it there at the scale it was displayed at.
+    const struct TCOD_Console* console = context->direct_console;
+    TCOD_Error err = TCOD_sdl2_render_texture_setup(context->atlas, console, NULL, &context->cache_texture);
+    if (err < 0) return err;
+    err = TCOD_sdl2_render_texture(context->atlas, console, NULL, context->cache_texture);
+    if (err < 0) return err;
+  }
   if (!context->cache_texture) {
     TCOD_set_errorv("Nothing to save before the first frame.");
     *width = 0;
@@ -822,6 +1310,18 @@ static TCOD_Error sdl2_set_tileset(struct TCOD_Context* __restrict self, TCOD_Ti
   }
   return TCOD_E_OK;
 }
+/**
+    Change the filter used for pre-scaled tiles.  The atlas is rescaled by the next render.
+ */
+static TCOD_Error sdl2_set_tile_scaling(struct TCOD_Context* __restrict self, TCOD_ScaleFilter filter) {
+  if (filter != TCOD_SCALE_FILTER_NONE && filter != TCOD_SCALE_FILTER_NEAREST && filter != TCOD_SCALE_FILTER_LINEAR) {
+    TCOD_set_errorvf("Invalid scale filter %i.", (int)filter);
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  struct TCOD_RendererSDL2* context = self->contextdata_;
+  context->scale_filter = filter;
+  return TCOD_E_OK;
+}
 static TCOD_Error sdl2_recommended_console_size(
     struct TCOD_Context* __restrict self, float magnification, int* __restrict columns, int* __restrict rows) {
   struct TCOD_RendererSDL2* context = self->contextdata_;
@@ -924,6 +1424,7 @@ struct TCOD_Context* TCOD_renderer_init_sdl2(
   context->c_screen_capture_ = sdl2_screen_capture;
   context->c_set_tileset_ = sdl2_set_tileset;
   context->c_recommended_console_size_ = sdl2_recommended_console_size;
+  context->c_set_tile_scaling_ = sdl2_set_tile_scaling;
 
   SDL_AddEventWatch(sdl2_handle_event, sdl2_data);
   sdl2_data->window = SDL_CreateWindow(title, x, y, pixel_width, pixel_height, window_flags);
@@ -43,6 +43,8 @@
 struct SDL_Window;
 struct SDL_Renderer;
 struct SDL_Texture;
+struct TCOD_VertexBufferSDL2;
+struct TCOD_AtlasPagesSDL2;
 /**
     An SDL2 tileset atlas.  This prepares a tileset for use with SDL2.
     \rst
@@ -52,14 +54,24 @@ struct SDL_Texture;
 typedef struct TCOD_TilesetAtlasSDL2 {
   /** The renderer used to create this atlas. */
   struct SDL_Renderer* renderer;
-  /** The atlas texture. */
+  /**
+      The first atlas texture page.
+
+      This is no longer the whole tileset.  Tiles are uploaded to a slot on any page the first time they're drawn and
+      can be evicted later, so a tile ID does not map to a fixed position on this texture.  Slots may also be larger
+      than the tileset tiles when tiles are pre-scaled.
+   */
   struct SDL_Texture* texture;
   /** The tileset used to create this atlas. Internal use only. */
   struct TCOD_Tileset* tileset;
   /** Internal use only. */
   struct TCOD_TilesetObserver* observer;
-  /** Internal use only. */
+  /** Internal use only.  The number of tile slot columns on each page texture. */
   int texture_columns;
+  /** Internal use only.  Vertex data reused by each render with this atlas. */
+  struct TCOD_VertexBufferSDL2* vertex_buffer;
+  /** Internal use only.  All page textures and the slot of each resident tile. */
+  struct TCOD_AtlasPagesSDL2* pages;
 } TCOD_TilesetAtlasSDL2;
 /***************************************************************************
     @brief Info needed to convert between mouse pixel and tile coordinates.
@@ -95,6 +107,9 @@ struct TCOD_RendererSDL2 {
   uint32_t sdl_subsystems;  // Which subsystems where initialzed by this context.
   // Mouse cursor transform values of the last viewport used.
   TCOD_RendererSDL2CursorTransform cursor_transform;
+  TCOD_ScaleFilter scale_filter;  // Filter for pre-scaled tiles, or TCOD_SCALE_FILTER_NONE to always use cache_texture.
+  struct TCOD_Console* direct_console;  // A copy of the last console drawn directly to the window, for screen captures.
+  int targets_reset_count;  // The number of render target resets already handled by the cache console.
 };
 #ifdef __cplusplus
 extern "C" {
@@ -125,6 +140,25 @@ TCOD_PUBLIC TCOD_NODISCARD struct TCOD_TilesetAtlasSDL2* TCOD_sdl2_atlas_new(
     Delete an SDL2 tileset atlas.
  */
 TCOD_PUBLIC void TCOD_sdl2_atlas_delete(struct TCOD_TilesetAtlasSDL2* atlas);
+/**
+    Store the tiles of `atlas` enlarged `scale` times, resampled with `filter`.
+
+    Consoles rendered with this atlas are drawn `scale` times larger, so the tiles don't need to be scaled again when
+    they're displayed.  Tiles are resampled when they're uploaded instead of every frame.
+
+    A `scale` of 1 stores the tiles at their original size and ignores `filter`.
+    Otherwise `filter` must not be `TCOD_SCALE_FILTER_NONE`.
+
+    Changing the scale discards the atlas textures, tiles are uploaded again as they're drawn.
+
+    Returns a negative value on an error, check `TCOD_get_error`.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_sdl2_atlas_set_scale(
+    struct TCOD_TilesetAtlasSDL2* atlas, int scale, TCOD_ScaleFilter filter);
 /**
     Setup a cache and target texture for rendering.
 
@@ -142,7 +176,8 @@ TCOD_PUBLIC void TCOD_sdl2_atlas_delete(struct TCOD_TilesetAtlasSDL2* atlas);
     `target` must be a pointer to where you want the output texture to be placed.
     The texture at `*target` may be deleted or recreated.  When this function
     is successful then the texture at `*target` will be non-NULL and will be
-    exactly fitted to the size of `console` and the tile size of `atlas`.
+    exactly fitted to the size of `console` and the tile size of `atlas`,
+    including any scale set with `TCOD_sdl2_atlas_set_scale`.
 
     If SDL2 ever provides a `SDL_RENDER_TARGETS_RESET` event then the console
     at `*cache` must be deleted and set to NULL, or else the next render will
@@ -176,7 +211,8 @@ TCOD_PUBLIC TCOD_Error TCOD_sdl2_render_texture_setup(
 
     `target` can be NULL, or be pointer an SDL2 texture used as the output.
     If `target` is not NULL then it should be the size of the console times the
-    size of the individual tiles to fit the entire output.
+    size of the individual tiles to fit the entire output.  Tiles are drawn at
+    the scale set with `TCOD_sdl2_atlas_set_scale`.
 
     If `target` is NULL then the current render target is used instead, the
     drawn area will not be scaled to fit the render target.
@@ -32,22 +32,27 @@
 #include "renderer_xterm.h"
 #ifndef NO_SDL
 #include <SDL.h>
+#include <errno.h>
 #include <limits.h>
 #include <locale.h>
 #include <signal.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if defined(_WIN32)
 #include <windows.h>
 #elif !defined(__MINGW32__)
 #include <signal.h>
+#include <sys/ioctl.h>
 #include <termios.h>
 #include <unistd.h>
 #endif
 
 #include "console_types.h"
 #include "error.h"
+#include "libtcod_int.h"
 #include "logging.h"
 
 #define DOUBLE_CLICK_TIME 500
@@ -72,6 +77,16 @@ static struct {
     .lock = NULL,
     .out = NULL,
 };
+/// The last known terminal size.  Updated from SIGWINCH so that frames don't need to poll the terminal.
+static struct {
+  volatile sig_atomic_t columns;
+  volatile sig_atomic_t rows;
+  volatile sig_atomic_t stale;  // If true then the size must be queried again before it is used.
+} g_terminal_size_cache = {
+    .columns = 0,
+    .rows = 0,
+    .stale = 1,
+};
 static struct {
   int button_down;
   Uint32 last_mouse_down_timestamp;
@@ -86,9 +101,20 @@ static struct {
     .last_mouse_motion_y = -1,
 };
 
+/// How many colors the terminal can display, detected from the environment.
+enum XtermColorMode {
+  XTERM_COLORS_TRUECOLOR,  // 24-bit colors.
+  XTERM_COLORS_256,  // The xterm 256 color palette.
+  XTERM_COLORS_16,  // The 8 ANSI colors and their bright variants.
+};
+
 struct TCOD_RendererXterm {
+  enum XtermColorMode color_mode;
   TCOD_Console* cache;
   SDL_Thread* input_thread;
+  char* out_buffer;  // Output for the current frame, sent to the terminal all at once.
+  size_t out_length;
+  size_t out_capacity;
 };
 
 static char* ucs4_to_utf8(int ucs4, char out[5]) {
@@ -159,6 +185,234 @@ static TCOD_Error xterm_get_terminal_size(struct TerminalSizeOut* out) {
   return TCOD_E_ERROR;
 }
 
+/// Query the terminal size from the OS without a round-trip through the terminal.  Async-signal-safe on POSIX.
+static bool xterm_query_os_terminal_size(int* columns, int* rows) {
+#if defined(_WIN32)
+  CONSOLE_SCREEN_BUFFER_INFO info;
+  if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) return false;
+  *columns = info.srWindow.Right - info.srWindow.Left + 1;
+  *rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+  return true;
+#elif !defined(__MINGW32__)
+  struct winsize size;
+  if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) < 0 || size.ws_col == 0 || size.ws_row == 0) return false;
+  *columns = size.ws_col;
+  *rows = size.ws_row;
+  return true;
+#else
+  return false;
+#endif
+}
+/// Return the cached terminal size, only querying the terminal when the cache is stale.
+static TCOD_Error xterm_get_cached_terminal_size(int* columns, int* rows) {
+  if (g_terminal_size_cache.stale) {
+    int new_columns;
+    int new_rows;
+    if (!xterm_query_os_terminal_size(&new_columns, &new_rows)) {
+      struct TerminalSizeOut size_out;
+      TCOD_Error err = xterm_get_terminal_size(&size_out);  // Slow fallback which polls the terminal.
+      if (err < 0) {
+        *columns = *rows = 0;
+        return err;
+      }
+      new_columns = size_out.columns;
+      new_rows = size_out.rows;
+    }
+    g_terminal_size_cache.columns = new_columns;
+    g_terminal_size_cache.rows = new_rows;
+#ifndef _WIN32
+    g_terminal_size_cache.stale = 0;  // Windows has no resize signal, so the size is queried every time there.
+#endif
+  }
+  *columns = g_terminal_size_cache.columns;
+  *rows = g_terminal_size_cache.rows;
+  return TCOD_E_OK;
+}
+/// Make room for `extra` more bytes in the frame buffer.  Returns false if memory could not be allocated.
+static bool xterm_out_reserve(struct TCOD_RendererXterm* context, size_t extra) {
+  if (context->out_length + extra <= context->out_capacity) return true;
+  size_t new_capacity = context->out_capacity ? context->out_capacity : 4096;
+  while (new_capacity < context->out_length + extra) new_capacity *= 2;
+  char* new_buffer = realloc(context->out_buffer, new_capacity);
+  if (!new_buffer) return false;
+  context->out_buffer = new_buffer;
+  context->out_capacity = new_capacity;
+  return true;
+}
+/// Send the frame buffer to the terminal with as few system calls as possible.
+static void xterm_out_flush(struct TCOD_RendererXterm* context) {
+  fflush(stdout);  // Anything written to stdout directly must come first.
+#if defined(_WIN32) || defined(__MINGW32__)
+  fwrite(context->out_buffer, 1, context->out_length, stdout);
+  fflush(stdout);
+#else
+  const char* data = context->out_buffer;
+  size_t remaining = context->out_length;
+  while (remaining) {
+    const ssize_t written = write(STDOUT_FILENO, data, remaining);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      break;  // Output is lost, there's nothing useful to do about it here.
+    }
+    data += written;
+    remaining -= (size_t)written;
+  }
+#endif
+  context->out_length = 0;
+}
+/// Append raw bytes to the frame buffer.
+static void xterm_out_write(struct TCOD_RendererXterm* context, const char* data, size_t length) {
+  if (!xterm_out_reserve(context, length)) {
+    xterm_out_flush(context);  // Out of memory, fall back to unbuffered output.
+    fwrite(data, 1, length, stdout);
+    return;
+  }
+  memcpy(context->out_buffer + context->out_length, data, length);
+  context->out_length += length;
+}
+/// Append formatted text to the frame buffer.
+static void xterm_out_printf(struct TCOD_RendererXterm* context, const char* format, ...) {
+  char small[64];
+  va_list args;
+  va_start(args, format);
+  const int length = vsnprintf(small, sizeof(small), format, args);
+  va_end(args);
+  if (length < 0) return;
+  if ((size_t)length < sizeof(small)) {
+    xterm_out_write(context, small, (size_t)length);
+    return;
+  }
+  if (!xterm_out_reserve(context, (size_t)length + 1)) return;
+  va_start(args, format);
+  vsnprintf(context->out_buffer + context->out_length, (size_t)length + 1, format, args);
+  va_end(args);
+  context->out_length += (size_t)length;
+}
+/// Return the color mode supported by the terminal according to `COLORTERM` and `TERM`.
+static enum XtermColorMode xterm_detect_color_mode(void) {
+  const char* colorterm = getenv("COLORTERM");
+  if (colorterm && (strcmp(colorterm, "truecolor") == 0 || strcmp(colorterm, "24bit") == 0)) {
+    return XTERM_COLORS_TRUECOLOR;
+  }
+  const char* term = getenv("TERM");
+  if (!term) return XTERM_COLORS_TRUECOLOR;  // Windows terminals don't set TERM but do support 24-bit color.
+  if (strstr(term, "truecolor") || strstr(term, "direct")) return XTERM_COLORS_TRUECOLOR;
+  if (strstr(term, "256color")) return XTERM_COLORS_256;
+  return XTERM_COLORS_16;
+}
+// clang-format off
+/// The default xterm colors of the 16 color palette.
+static const TCOD_ColorRGB xterm_palette_16[16] = {
+    {0, 0, 0}, {205, 0, 0}, {0, 205, 0}, {205, 205, 0}, {0, 0, 238}, {205, 0, 205}, {0, 205, 205}, {229, 229, 229},
+    {127, 127, 127}, {255, 0, 0}, {0, 255, 0}, {255, 255, 0}, {92, 92, 255}, {255, 0, 255}, {0, 255, 255},
+    {255, 255, 255},
+};
+// clang-format on
+/// Channel levels of the 6x6x6 color cube in the 256 color palette.
+static const int xterm_cube_levels[6] = {0, 95, 135, 175, 215, 255};
+/// Quantization tables are indexed by the top 5 bits of each channel.
+#define XTERM_LUT_BITS 5
+#define XTERM_LUT_SIZE (1 << (XTERM_LUT_BITS * 3))
+static uint8_t g_xterm_lut_256[XTERM_LUT_SIZE];
+static uint8_t g_xterm_lut_16[XTERM_LUT_SIZE];
+static bool g_xterm_luts_ready = false;
+/// Weighted squared distance between two colors, green is weighted highest to roughly follow perceived brightness.
+static int xterm_color_distance(int r0, int g0, int b0, int r1, int g1, int b1) {
+  return 2 * (r0 - r1) * (r0 - r1) + 4 * (g0 - g1) * (g0 - g1) + 3 * (b0 - b1) * (b0 - b1);
+}
+/// Return the index of the nearest level in the 256 color cube.
+static int xterm_nearest_cube_level(int c) {
+  if (c < 48) return 0;
+  if (c < 115) return 1;
+  return (c - 35) / 40;
+}
+/// Return the nearest color in the 256 color palette, ignoring the configurable first 16 entries.
+static uint8_t xterm_nearest_256(int r, int g, int b) {
+  const int cube_r = xterm_nearest_cube_level(r);
+  const int cube_g = xterm_nearest_cube_level(g);
+  const int cube_b = xterm_nearest_cube_level(b);
+  const int cube_distance = xterm_color_distance(
+      r, g, b, xterm_cube_levels[cube_r], xterm_cube_levels[cube_g], xterm_cube_levels[cube_b]);
+  // The grayscale ramp goes from 8 to 238 in steps of 10.
+  const int average = (r + g + b) / 3;
+  const int gray_i = average < 8 ? 0 : average > 238 ? 23 : (average - 3) / 10;
+  const int gray = 8 + gray_i * 10;
+  const int gray_distance = xterm_color_distance(r, g, b, gray, gray, gray);
+  if (gray_distance < cube_distance) return (uint8_t)(232 + gray_i);
+  return (uint8_t)(16 + cube_r * 36 + cube_g * 6 + cube_b);
+}
+/// Return the nearest color in the 16 color palette.
+static uint8_t xterm_nearest_16(int r, int g, int b) {
+  int best_i = 0;
+  int best_distance = INT_MAX;
+  for (int i = 0; i < 16; ++i) {
+    const TCOD_ColorRGB* color = &xterm_palette_16[i];
+    const int distance = xterm_color_distance(r, g, b, color->r, color->g, color->b);
+    if (distance < best_distance) {
+      best_distance = distance;
+      best_i = i;
+    }
+  }
+  return (uint8_t)best_i;
+}
+/// Fill the quantization tables on first use.
+static void xterm_init_luts(void) {
+  if (g_xterm_luts_ready) return;
+  const int shift = 8 - XTERM_LUT_BITS;
+  const int half_step = 1 << (shift - 1);  // Sample the center of each bucket.
+  for (int i = 0; i < XTERM_LUT_SIZE; ++i) {
+    const int r = ((i >> (XTERM_LUT_BITS * 2)) << shift) + half_step;
+    const int g = (((i >> XTERM_LUT_BITS) & ((1 << XTERM_LUT_BITS) - 1)) << shift) + half_step;
+    const int b = ((i & ((1 << XTERM_LUT_BITS) - 1)) << shift) + half_step;
+    g_xterm_lut_256[i] = xterm_nearest_256(r, g, b);
+    g_xterm_lut_16[i] = xterm_nearest_16(r, g, b);
+  }
+  g_xterm_luts_ready = true;
+}
+/// Return the table index of `color`.
+static int xterm_lut_index(TCOD_ColorRGBA color) {
+  const int shift = 8 - XTERM_LUT_BITS;
+  return ((color.r >> shift) << (XTERM_LUT_BITS * 2)) | ((color.g >> shift) << XTERM_LUT_BITS) | (color.b >> shift);
+}
+/**
+    Convert `color` to what will be sent to the terminal in the current color mode.
+
+    Colors which map to the same value look identical on the terminal, so this is also used to skip redundant SGR codes.
+ */
+static int xterm_map_color(const struct TCOD_RendererXterm* context, TCOD_ColorRGBA color) {
+  switch (context->color_mode) {
+    case XTERM_COLORS_TRUECOLOR:
+    default:
+      return (color.r << 16) | (color.g << 8) | color.b;
+    case XTERM_COLORS_256:
+      return g_xterm_lut_256[xterm_lut_index(color)];
+    case XTERM_COLORS_16:
+      return g_xterm_lut_16[xterm_lut_index(color)];
+  }
+}
+/// Append an SGR parameter for a color from `xterm_map_color`, without the leading CSI or the trailing 'm'.
+static void xterm_out_color(struct TCOD_RendererXterm* context, bool background, int color) {
+  switch (context->color_mode) {
+    case XTERM_COLORS_TRUECOLOR:
+    default:
+      xterm_out_printf(
+          context,
+          "%s;2;%d;%d;%d",
+          background ? "48" : "38",
+          (color >> 16) & 0xff,
+          (color >> 8) & 0xff,
+          color & 0xff);
+      return;
+    case XTERM_COLORS_256:
+      xterm_out_printf(context, "%s;5;%d", background ? "48" : "38", color);
+      return;
+    case XTERM_COLORS_16:
+      // 30-37 and 40-47 are the normal colors, 90-97 and 100-107 are the bright colors.
+      xterm_out_printf(context, "%d", (color < 8 ? 30 : 82) + (background ? 10 : 0) + color);
+      return;
+  }
+}
+static bool xterm_rgb_equal(TCOD_ColorRGBA a, TCOD_ColorRGBA b) { return a.r == b.r && a.g == b.g && a.b == b.b; }
 static TCOD_Error xterm_present(
     struct TCOD_Context* __restrict self,
     const struct TCOD_Console* __restrict console,
@@ -172,41 +426,78 @@ static TCOD_Error xterm_present(
   if (!context->cache) {
     context->cache = TCOD_console_new(console->w, console->h);
     for (int i = 0; i < context->cache->elements; ++i) context->cache->tiles[i].ch = -1;
+    (void)TCOD_console_set_write_tracking(context->cache, true);  // Optional, allows skipping unchanged rows.
   }
-  struct TerminalSizeOut term_size;
-  xterm_get_terminal_size(&term_size);  // This polls the terminal and might be too slow.
+  int term_columns;
+  int term_rows;
+  xterm_get_cached_terminal_size(&term_columns, &term_rows);
 
-  fprintf(stdout, "\x1b[?25l");  // Cursor un-hiding on Windows after window is resized.
-  for (int y = 0; y < console->h && y < term_size.rows; ++y) {
-    fprintf(stdout, "\x1b[%d;0H", y);  // Move cursor to start of next line.
-    int skip_tiles = 0;  // Skip unchanged tiles.
-    for (int x = 0; x < console->w && x < term_size.columns; ++x) {
+  xterm_out_write(context, "\x1b[?25l", 6);  // Cursor un-hiding on Windows after window is resized.
+  int cursor_x = -1;  // Known cursor position, negative if unknown.
+  int cursor_y = -1;
+  bool sgr_set = false;  // True once the colors below have been sent this frame.
+  int sgr_fg = 0;  // Colors last sent to the terminal, from xterm_map_color.
+  int sgr_bg = 0;
+  for (int y = 0; y < console->h && y < term_rows; ++y) {
+    const TCOD_ConsoleDirtySpan span = TCOD_console_get_redraw_span_(console, context->cache, y);
+    for (int x = span.begin; x < span.end && x < term_columns; ++x) {
       TCOD_ConsoleTile* prev_tile = &context->cache->tiles[console->w * y + x];
       const TCOD_ConsoleTile* tile = &console->tiles[console->w * y + x];
-      if (tile->ch == prev_tile->ch && tile->fg.r == prev_tile->fg.r && tile->fg.g == prev_tile->fg.g &&
-          tile->fg.b == prev_tile->fg.b && tile->bg.r == prev_tile->bg.r && tile->bg.g == prev_tile->bg.g &&
-          tile->bg.b == prev_tile->bg.b) {
-        ++skip_tiles;
-        continue;
+      if (tile->ch == prev_tile->ch && xterm_rgb_equal(tile->fg, prev_tile->fg) &&
+          xterm_rgb_equal(tile->bg, prev_tile->bg)) {
+        continue;  // Skipped tiles are handled when the cursor is moved.
       }
-      if (skip_tiles) {
-        fprintf(stdout, "\x1b[%dC", skip_tiles);  // Move cursor forward.
-        skip_tiles = 0;
+      if (cursor_y == y && cursor_x < x && x - cursor_x <= 2) {
+        // Reprinting a short gap of plain text is cheaper than a cursor move.
+        bool reprint = true;
+        for (int gap_x = cursor_x; gap_x < x; ++gap_x) {
+          const TCOD_ConsoleTile* gap = &console->tiles[console->w * y + gap_x];
+          if (gap->ch < 0x20 || gap->ch >= 0x7F || xterm_map_color(context, gap->fg) != sgr_fg ||
+              xterm_map_color(context, gap->bg) != sgr_bg) {
+            reprint = false;
+            break;
+          }
+        }
+        for (; reprint && cursor_x < x; ++cursor_x) {
+          const char gap_ch = (char)console->tiles[console->w * y + cursor_x].ch;
+          xterm_out_write(context, &gap_ch, 1);
+        }
+      }
+      if (cursor_y != y || cursor_x > x) {
+        xterm_out_printf(context, "\x1b[%d;%dH", y + 1, x + 1);  // Move cursor to an absolute position.
+      } else if (x - cursor_x == 1) {
+        xterm_out_write(context, "\x1b[C", 3);  // Move cursor forward once.
+      } else if (cursor_x < x) {
+        xterm_out_printf(context, "\x1b[%dC", x - cursor_x);  // Move cursor forward.
+      }
+      const int fg = xterm_map_color(context, tile->fg);
+      const int bg = xterm_map_color(context, tile->bg);
+      const bool fg_changed = !sgr_set || fg != sgr_fg;
+      const bool bg_changed = !sgr_set || bg != sgr_bg;
+      if (fg_changed || bg_changed) {
+        xterm_out_write(context, "\x1b[", 2);
+        if (fg_changed) xterm_out_color(context, false, fg);
+        if (fg_changed && bg_changed) xterm_out_write(context, ";", 1);
+        if (bg_changed) xterm_out_color(context, true, bg);
+        xterm_out_write(context, "m", 1);
+        sgr_set = true;
+        sgr_fg = fg;
+        sgr_bg = bg;
       }
       char utf8[5];
-      fprintf(  // Print a character with colors.
-          stdout,
-          "\x1b[38;2;%u;%u;%u;48;2;%u;%u;%um%s",
-          tile->fg.r,
-          tile->fg.g,
-          tile->fg.b,
-          tile->bg.r,
-          tile->bg.g,
-          tile->bg.b,
-          ucs4_to_utf8(tile->ch & 0x10FFFF, utf8));
+      ucs4_to_utf8(tile->ch & 0x10FFFF, utf8);
+      xterm_out_write(context, utf8, strlen(utf8));
       *prev_tile = *tile;
+      cursor_x = x + 1;
+      cursor_y = y;
+      if (cursor_x >= term_columns) cursor_y = -1;  // The cursor may be pending a wrap, its position is unknown.
     }
   }
+  xterm_out_flush(context);
+  TCOD_console_end_redraw_(console, context->cache);
+  // Parts of the console outside of the terminal were not drawn and must be checked again on the next frame.
+  TCOD_console_mark_dirty(context->cache, term_columns, 0, console->w - term_columns, console->h);
+  TCOD_console_mark_dirty(context->cache, 0, term_rows, console->w, console->h - term_rows);
   return TCOD_E_OK;
 }
 /// Undo the terminal setup performed on initialization.
@@ -230,7 +521,11 @@ static void xterm_cleanup(void) {
 
 static void xterm_destructor(struct TCOD_Context* __restrict self) {
   struct TCOD_RendererXterm* context = self->contextdata_;
-  if (context) free(context);
+  if (context) {
+    TCOD_console_delete(context->cache);
+    free(context->out_buffer);
+    free(context);
+  }
   xterm_cleanup();
 }
 /// Send keyboard and text input events to SDL.
@@ -580,18 +875,26 @@ static TCOD_Error xterm_recommended_console_size(
     struct TCOD_Context* __restrict self, float magnification, int* __restrict columns, int* __restrict rows) {
   (void)self;  // Unused.
   (void)magnification;
-  struct TerminalSizeOut size_out;
-  TCOD_Error err = xterm_get_terminal_size(&size_out);
+  int term_columns;
+  int term_rows;
+  TCOD_Error err = xterm_get_cached_terminal_size(&term_columns, &term_rows);
   if (err < 0) return err;
-  *columns = size_out.columns;
-  *rows = size_out.rows;
+  if (columns) *columns = term_columns;
+  if (rows) *rows = term_rows;
   return TCOD_E_OK;
 }
 
 #ifndef _WIN32
 static void xterm_on_window_change_signal(int signum) {
   int columns, rows;
-  xterm_recommended_console_size(NULL, 1.0, &columns, &rows);
+  if (xterm_query_os_terminal_size(&columns, &rows)) {
+    g_terminal_size_cache.columns = columns;
+    g_terminal_size_cache.rows = rows;
+    g_terminal_size_cache.stale = 0;
+  } else {
+    g_terminal_size_cache.stale = 1;
+    xterm_recommended_console_size(NULL, 1.0, &columns, &rows);
+  }
   SDL_Event resize_event = {
       .window = {
           .type = SDL_WINDOWEVENT,
@@ -631,6 +934,8 @@ TCOD_Context* TCOD_renderer_init_xterm(
     TCOD_set_errorv("Could not allocate memory.");
     return NULL;
   }
+  data->color_mode = xterm_detect_color_mode();
+  if (data->color_mode != XTERM_COLORS_TRUECOLOR) xterm_init_luts();
   context->c_present_ = &xterm_present;
   context->c_destructor_ = &xterm_destructor;
   context->c_recommended_console_size_ = xterm_recommended_console_size;
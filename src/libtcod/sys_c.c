@@ -91,6 +91,10 @@ void TCOD_sys_shutdown(void) {
   if (TCOD_ctx.root) {
     TCOD_console_delete(TCOD_ctx.root);
   }
+  if (TCOD_ctx.fade_console) {
+    TCOD_console_delete(TCOD_ctx.fade_console);
+    TCOD_ctx.fade_console = NULL;
+  }
   if (TCOD_ctx.engine) {
     TCOD_context_delete(TCOD_ctx.engine);
     TCOD_ctx.engine = NULL;
@@ -104,6 +108,7 @@ void TCOD_sys_map_ascii_to_font(int asciiCode, int fontCharX, int fontCharY) {
   if (!TCOD_ctx.tileset) {
     return;
   }
+  TCOD_context_async_sync_(TCOD_ctx.engine);  // A render thread could be reading the tileset.
   TCOD_tileset_assign_tile(TCOD_ctx.tileset, TCOD_ctx.tileset->virtual_columns * fontCharY + fontCharX, asciiCode);
 }
 /**
@@ -119,7 +124,7 @@ static void TCOD_sys_map_clone_(int new_codepoint, int old_codepoint) {
   if (old_codepoint >= TCOD_ctx.tileset->character_map_length) {
     return;
   }
-  TCOD_sys_map_ascii_to_font(new_codepoint, TCOD_ctx.tileset->character_map[old_codepoint], 0);
+  TCOD_sys_map_ascii_to_font(new_codepoint, TCOD_tileset_get_tile_id_(TCOD_ctx.tileset, old_codepoint), 0);
 }
 /**
     Decode the font layout depending on the current flags.
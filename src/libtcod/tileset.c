@@ -34,15 +34,21 @@
 #ifndef TCOD_NO_PNG
 #include <lodepng.h>
 #endif  // TCOD_NO_PNG
+#include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "color.h"
+#include "console_types.h"
 
 // Starting sizes of arrays:
 #define DEFAULT_TILES_LENGTH 256
-#define DEFAULT_CHARMAP_LENGTH 256
+#define DEFAULT_CHARMAP_PAGES 1
+
+/// The shared page for unassigned codepoints.  Never written to.
+static const int empty_charmap_page[TCOD_CHARMAP_PAGE_LENGTH_] = {0};
 
 TCOD_Tileset* TCOD_tileset_new(int tile_width, int tile_height) {
   TCOD_Tileset* tileset = calloc(sizeof(*tileset), 1);
@@ -66,8 +72,15 @@ void TCOD_tileset_delete(TCOD_Tileset* tileset) {
   while (tileset->observer_list) {
     TCOD_tileset_observer_delete(tileset->observer_list);
   }
+  if (tileset->on_tile_loader_delete) {
+    tileset->on_tile_loader_delete(tileset->tile_loader);
+  }
   free(tileset->pixels);
-  free(tileset->character_map);
+  for (int i = 0; i < tileset->character_map_length / TCOD_CHARMAP_PAGE_LENGTH_; ++i) {
+    if (tileset->character_map_pages[i] != empty_charmap_page) free(tileset->character_map_pages[i]);
+  }
+  free(tileset->character_map_pages);
+  free(tileset->batch_tiles);
   free(tileset);
 }
 struct TCOD_TilesetObserver* TCOD_tileset_observer_new(struct TCOD_Tileset* tileset) {
@@ -115,23 +128,22 @@ static TCOD_Error TCOD_tileset_charmap_reserve(TCOD_Tileset* tileset, int want)
   if (want <= tileset->character_map_length) {
     return TCOD_E_OK;
   }
-  int new_length = tileset->character_map_length;
-  if (new_length == 0) {
-    new_length = DEFAULT_CHARMAP_LENGTH;
-  }
-  while (want > new_length) {
-    new_length *= 2;
+  const int old_pages = tileset->character_map_length / TCOD_CHARMAP_PAGE_LENGTH_;
+  const int want_pages = (int)(((int64_t)want + TCOD_CHARMAP_PAGE_LENGTH_ - 1) / TCOD_CHARMAP_PAGE_LENGTH_);
+  int new_pages = old_pages ? old_pages : DEFAULT_CHARMAP_PAGES;
+  while (want_pages > new_pages) {
+    new_pages = new_pages > INT_MAX / TCOD_CHARMAP_PAGE_LENGTH_ / 2 ? want_pages : new_pages * 2;
   }
-  int* new_charmap = realloc(tileset->character_map, sizeof(int) * new_length);
+  int** new_charmap = realloc(tileset->character_map_pages, sizeof(*new_charmap) * new_pages);
   if (!new_charmap) {
     TCOD_set_errorv("Could not allocate enough memory for the tileset.");
     return TCOD_E_OUT_OF_MEMORY;
   }
-  for (int i = tileset->character_map_length; i < new_length; ++i) {
-    new_charmap[i] = 0;
+  for (int i = old_pages; i < new_pages; ++i) {
+    new_charmap[i] = (int*)empty_charmap_page;  // Only read until a codepoint on this page is assigned.
   }
-  tileset->character_map_length = new_length;
-  tileset->character_map = new_charmap;
+  tileset->character_map_length = new_pages * TCOD_CHARMAP_PAGE_LENGTH_;
+  tileset->character_map_pages = new_charmap;
   return TCOD_E_OK;
 }
 TCOD_Error TCOD_tileset_reserve(TCOD_Tileset* tileset, int want) {
@@ -178,15 +190,6 @@ TCOD_Error TCOD_tileset_reserve(TCOD_Tileset* tileset, int want) {
  *
  *  Returns 0 for unassigned codepoints.
  */
-static int TCOD_tileset_get_tile_id(const TCOD_Tileset* tileset, int codepoint) {
-  if (!tileset) {
-    return 0;
-  }
-  if (codepoint < 0 || codepoint >= tileset->character_map_length) {
-    return 0;
-  }
-  return tileset->character_map[codepoint];
-}
 int TCOD_tileset_assign_tile(struct TCOD_Tileset* tileset, int tile_id, int codepoint) {
   if (tile_id < 0 || tile_id >= tileset->tiles_count) {
     TCOD_set_errorv("Tile_ID is out of bounds.");
@@ -200,7 +203,19 @@ int TCOD_tileset_assign_tile(struct TCOD_Tileset* tileset, int tile_id, int code
   if (err < 0) {
     return err;
   }
-  tileset->character_map[codepoint] = tile_id;
+  int** page = &tileset->character_map_pages[codepoint / TCOD_CHARMAP_PAGE_LENGTH_];
+  if (*page == empty_charmap_page) {
+    if (tile_id == 0) {
+      return tile_id;  // Already unassigned.
+    }
+    int* new_page = calloc(TCOD_CHARMAP_PAGE_LENGTH_, sizeof(*new_page));
+    if (!new_page) {
+      TCOD_set_errorv("Could not allocate enough memory for the tileset.");
+      return TCOD_E_OUT_OF_MEMORY;
+    }
+    *page = new_page;
+  }
+  (*page)[codepoint % TCOD_CHARMAP_PAGE_LENGTH_] = tile_id;
   return tile_id;
 }
 /**
@@ -224,7 +239,7 @@ static int TCOD_tileset_generate_tile(struct TCOD_Tileset* tileset) {
  *  Returns a negative value on error.
  */
 static int TCOD_tileset_generate_codepoint(struct TCOD_Tileset* tileset, int codepoint) {
-  int tile_id = TCOD_tileset_get_tile_id(tileset, codepoint);
+  int tile_id = TCOD_tileset_get_tile_id_(tileset, codepoint);
   if (tile_id != 0) {
     return tile_id;
   }
@@ -238,12 +253,55 @@ const struct TCOD_ColorRGBA* TCOD_tileset_get_tile(const TCOD_Tileset* tileset,
   if (!tileset) {
     return NULL;
   }
-  int tile_id = TCOD_tileset_get_tile_id(tileset, codepoint);
+  int tile_id = TCOD_tileset_get_tile_id_(tileset, codepoint);
   if (tile_id < 0) {
     return NULL;  // No tile for the given codepoint in this tileset.
   }
   return tileset->pixels + tileset->tile_length * tile_id;
 }
+/**
+ *  Return true if `codepoint` is not assigned to a tile yet.
+ */
+static bool TCOD_tileset_is_missing(const TCOD_Tileset* tileset, int codepoint) {
+  return codepoint > 0 && TCOD_tileset_get_tile_id_(tileset, codepoint) == 0;
+}
+TCOD_Error TCOD_tileset_request_tile(TCOD_Tileset* tileset, int codepoint) {
+  if (!tileset) {
+    TCOD_set_errorv("Tileset argument must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (!tileset->on_tile_missing || !TCOD_tileset_is_missing(tileset, codepoint)) {
+    return TCOD_E_OK;
+  }
+  const int err = tileset->on_tile_missing(tileset, codepoint);
+  return err < 0 ? (TCOD_Error)err : TCOD_E_OK;
+}
+TCOD_Error TCOD_tileset_request_console_tiles(TCOD_Tileset* tileset, const struct TCOD_Console* console) {
+  if (!tileset) {
+    TCOD_set_errorv("Tileset argument must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (!console) {
+    TCOD_set_errorv("Console argument must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (!tileset->on_tile_missing) {
+    return TCOD_E_OK;  // All tiles were loaded up front.
+  }
+  TCOD_tileset_begin_batch(tileset);  // Upload all new tiles together.
+  for (int i = 0; i < console->elements; ++i) {
+    const int codepoint = console->tiles[i].ch;
+    if (!TCOD_tileset_is_missing(tileset, codepoint)) {
+      continue;
+    }
+    const int err = tileset->on_tile_missing(tileset, codepoint);
+    if (err < 0) {
+      (void)TCOD_tileset_end_batch(tileset);
+      return (TCOD_Error)err;
+    }
+  }
+  return TCOD_tileset_end_batch(tileset);
+}
 TCOD_Error TCOD_tileset_get_tile_(
     const TCOD_Tileset* __restrict tileset, int codepoint, struct TCOD_ColorRGBA* __restrict buffer) {
   if (!tileset) {
@@ -261,7 +319,66 @@ TCOD_Error TCOD_tileset_get_tile_(
   memcpy(buffer, tile, sizeof(*tile) * tileset->tile_length);
   return TCOD_E_OK;  // Tile exists and was copied to buffer.
 }
+void TCOD_tileset_begin_batch(TCOD_Tileset* tileset) {
+  if (!tileset) {
+    return;
+  }
+  ++tileset->batch_depth;
+}
+static int compare_int(const void* a, const void* b) {
+  const int lhs = *(const int*)a;
+  const int rhs = *(const int*)b;
+  return (lhs > rhs) - (lhs < rhs);
+}
+TCOD_Error TCOD_tileset_end_batch(TCOD_Tileset* tileset) {
+  if (!tileset) {
+    TCOD_set_errorv("Tileset argument must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (tileset->batch_depth <= 0) {
+    TCOD_set_errorv("TCOD_tileset_end_batch called without a batch in progress.");
+    return TCOD_E_ERROR;
+  }
+  if (--tileset->batch_depth > 0 || tileset->batch_tiles_length == 0) {
+    return TCOD_E_OK;
+  }
+  // Sort and remove duplicates.
+  qsort(tileset->batch_tiles, tileset->batch_tiles_length, sizeof(*tileset->batch_tiles), compare_int);
+  int count = 1;
+  for (int i = 1; i < tileset->batch_tiles_length; ++i) {
+    if (tileset->batch_tiles[i] != tileset->batch_tiles[count - 1]) {
+      tileset->batch_tiles[count++] = tileset->batch_tiles[i];
+    }
+  }
+  tileset->batch_tiles_length = 0;
+  TCOD_Error err = TCOD_E_OK;
+  for (struct TCOD_TilesetObserver* it = tileset->observer_list; it; it = it->next) {
+    if (it->on_tiles_changed) {
+      if (it->on_tiles_changed(it, tileset->batch_tiles, count) < 0) err = TCOD_E_ERROR;
+    } else if (it->on_tile_changed) {
+      for (int i = 0; i < count; ++i) {
+        if (it->on_tile_changed(it, tileset->batch_tiles[i]) < 0) err = TCOD_E_ERROR;
+      }
+    }
+  }
+  return err;
+}
 void TCOD_tileset_notify_tile_changed(TCOD_Tileset* tileset, int tile_id) {
+  if (tileset->batch_depth > 0) {
+    if (tileset->batch_tiles_length == tileset->batch_tiles_capacity) {
+      const int new_capacity = tileset->batch_tiles_capacity ? tileset->batch_tiles_capacity * 2 : 64;
+      int* new_tiles = realloc(tileset->batch_tiles, sizeof(*new_tiles) * new_capacity);
+      if (new_tiles) {
+        tileset->batch_tiles = new_tiles;
+        tileset->batch_tiles_capacity = new_capacity;
+      }
+    }
+    if (tileset->batch_tiles_length < tileset->batch_tiles_capacity) {
+      tileset->batch_tiles[tileset->batch_tiles_length++] = tile_id;
+      return;
+    }
+    // Out of memory, notify the observers right away instead.
+  }
   for (struct TCOD_TilesetObserver* it = tileset->observer_list; it; it = it->next) {
     if (it->on_tile_changed) {
       it->on_tile_changed(it, tile_id);
@@ -37,6 +37,7 @@
 #include "config.h"
 #include "error.h"
 
+struct TCOD_Console;
 struct TCOD_Tileset;
 struct TCOD_TilesetObserver {
   struct TCOD_Tileset* tileset;
@@ -44,6 +45,11 @@ struct TCOD_TilesetObserver {
   void* userdata;
   void (*on_observer_delete)(struct TCOD_TilesetObserver* observer);
   int (*on_tile_changed)(struct TCOD_TilesetObserver* observer, int tile_id);
+  /**
+      Called once at the end of a batch with the sorted and unique `tile_ids[count]` changed during it.
+      If NULL then `on_tile_changed` is called for each tile instead.
+   */
+  int (*on_tiles_changed)(struct TCOD_TilesetObserver* observer, const int* tile_ids, int count);
 };
 /**
     @brief A container for libtcod tileset graphics.
@@ -59,13 +65,53 @@ struct TCOD_Tileset {
   int tiles_capacity;
   int tiles_count;
   struct TCOD_ColorRGBA* __restrict pixels;
+  /** Codepoints below this can be looked up in `character_map_pages`.  A multiple of `TCOD_CHARMAP_PAGE_LENGTH_`. */
   int character_map_length;
-  int* __restrict character_map;
+  /**
+      Tile indexes for each codepoint, split into pages of `TCOD_CHARMAP_PAGE_LENGTH_` codepoints.
+
+      Pages without any assigned codepoints point to one shared read-only page of zeros, so memory use follows the
+      number of assigned pages instead of the highest codepoint.
+      Use `TCOD_tileset_get_tile_id_` to read this.
+   */
+  int** character_map_pages;
   struct TCOD_TilesetObserver* observer_list;
   int virtual_columns;
   volatile int ref_count;
+  /**
+      Called the first time a missing codepoint is requested, can be NULL.
+
+      This should assign the tile with `TCOD_tileset_set_tile_` if one can be made.
+      Returns a negative value on an error.
+   */
+  int (*on_tile_missing)(struct TCOD_Tileset* tileset, int codepoint);
+  /** Userdata for `on_tile_missing`.  Passed to `on_tile_loader_delete` when this tileset is deleted. */
+  void* tile_loader;
+  void (*on_tile_loader_delete)(void* tile_loader);
+  /** Nesting depth of `TCOD_tileset_begin_batch`.  Observers are not notified while this is above zero. */
+  int batch_depth;
+  /** Tiles changed during the current batch, can contain duplicates. */
+  int batch_tiles_length;
+  int batch_tiles_capacity;
+  int* batch_tiles;
 };
 typedef struct TCOD_Tileset TCOD_Tileset;
+#define TCOD_CHARMAP_PAGE_BITS_ 8
+#define TCOD_CHARMAP_PAGE_LENGTH_ (1 << TCOD_CHARMAP_PAGE_BITS_)
+/**
+    Return the tile index assigned to `codepoint`, or 0 if `codepoint` has no tile.
+
+    `tileset` must not be NULL.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+static inline int TCOD_tileset_get_tile_id_(const TCOD_Tileset* tileset, int codepoint) {
+  if (codepoint < 0 || codepoint >= tileset->character_map_length) return 0;
+  const int* page = tileset->character_map_pages[codepoint >> TCOD_CHARMAP_PAGE_BITS_];
+  return page[codepoint & (TCOD_CHARMAP_PAGE_LENGTH_ - 1)];
+}
 // clang-format off
 // Character maps are defined in this way so that the C and C++ API don't duplicate them.
 #define TCOD_CHARMAP_CP437_ {\
@@ -288,6 +334,64 @@ TCOD_PUBLIC int TCOD_tileset_assign_tile(struct TCOD_Tileset* tileset, int tile_
  */
 TCOD_NODISCARD
 TCOD_PUBLIC const struct TCOD_ColorRGBA* TCOD_tileset_get_tile(const TCOD_Tileset* tileset, int codepoint);
+/**
+    @brief Load the tile for `codepoint` if this tileset loads its tiles lazily.
+
+    Does nothing if the tile already exists or if this tileset has no `on_tile_missing` callback.
+    Observers are notified of any new tile.
+
+    @param tileset A TCOD_Tileset pointer, must not be NULL.
+    @param codepoint The Unicode codepoint to load.
+    @return Returns a negative value on error.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_NODISCARD
+TCOD_PUBLIC TCOD_Error TCOD_tileset_request_tile(TCOD_Tileset* tileset, int codepoint);
+/**
+    @brief Load any missing tiles used by `console` if this tileset loads its tiles lazily.
+
+    Renderers call this before drawing.
+    Call this yourself before passing a lazily loaded tileset to `TCOD_tileset_render_to_rgba` or
+    `TCOD_tileset_render_to_surface`.
+
+    @param tileset A TCOD_Tileset pointer, must not be NULL.
+    @param console The console about to be rendered, must not be NULL.
+    @return Returns a negative value on error.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_NODISCARD
+TCOD_PUBLIC TCOD_Error TCOD_tileset_request_console_tiles(TCOD_Tileset* tileset, const struct TCOD_Console* console);
+/**
+    @brief Start deferring tile change notifications for this tileset.
+
+    Changes made until the matching `TCOD_tileset_end_batch` are sent to observers together, which lets SDL2 atlases
+    upload many tiles with a few texture updates.
+    Batches can be nested, observers are notified when the outermost batch ends.
+
+    @param tileset A TCOD_Tileset pointer, must not be NULL.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC void TCOD_tileset_begin_batch(TCOD_Tileset* tileset);
+/**
+    @brief End a batch started with `TCOD_tileset_begin_batch`.
+
+    @param tileset A TCOD_Tileset pointer, must not be NULL.
+    @return Returns a negative value on error, such as an observer failing to update.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_tileset_end_batch(TCOD_Tileset* tileset);
 /**
  *  Return a new observer to this tileset.
  *
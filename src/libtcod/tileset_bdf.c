@@ -31,9 +31,10 @@
  */
 #include "tileset_bdf.h"
 
-#include <ctype.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -42,13 +43,14 @@
 
 TCOD_NODISCARD unsigned char* TCOD_load_binary_file_(const char* path, size_t* size);
 
-TCOD_Tileset* TCOD_load_bdf(const char* path) {
+TCOD_Tileset* TCOD_load_bdf(const char* path) { return TCOD_load_bdf_subset(path, 0, NULL); }
+TCOD_Tileset* TCOD_load_bdf_subset(const char* path, int codepoints_count, const int* codepoints) {
   size_t fsize;
   unsigned char* buffer = TCOD_load_binary_file_(path, &fsize);
   if (!buffer) {
     return NULL;
   }
-  TCOD_Tileset* tileset = TCOD_load_bdf_memory((int)fsize, buffer);
+  TCOD_Tileset* tileset = TCOD_load_bdf_memory_subset((int)fsize, buffer, codepoints_count, codepoints);
   free(buffer);
   return tileset;
 }
@@ -71,129 +73,164 @@ struct BDFLoader {
   TCOD_Tileset* tileset;
   /** Font bounding box. */
   struct BBox bbox;
+  /** A bitset of the codepoints to load, or NULL to load every glyph. */
+  const unsigned char* subset;
+  /** The highest codepoint in `subset`. */
+  int subset_max;
+  /** A single tile reused for every glyph. */
+  TCOD_ColorRGBA* pixels;
 };
 /**
-    Check for a keyword.
+    Hexadecimal digit values for each character, or 0 for non-digits.
 
-    Return 0 and move the cursor past the keyword if it is found.
+    The 0x10 bit is set for valid digits so that it survives being combined with the value of another digit.
+ */
+static const uint8_t hex_digit_table[256] = {
+    ['0'] = 0x10, ['1'] = 0x11, ['2'] = 0x12, ['3'] = 0x13, ['4'] = 0x14, ['5'] = 0x15, ['6'] = 0x16, ['7'] = 0x17,
+    ['8'] = 0x18, ['9'] = 0x19, ['A'] = 0x1A, ['B'] = 0x1B, ['C'] = 0x1C, ['D'] = 0x1D, ['E'] = 0x1E, ['F'] = 0x1F,
+    ['a'] = 0x1A, ['b'] = 0x1B, ['c'] = 0x1C, ['d'] = 0x1D, ['e'] = 0x1E, ['f'] = 0x1F,
+};
+/// Return true if the `length` characters at `word` are `keyword`, which must be a string literal.
+#define IS_KEYWORD(word, length, keyword) \
+  ((length) == sizeof(keyword) - 1 && memcmp((word), (keyword), sizeof(keyword) - 1) == 0)
+/**
+    Read the keyword at the start of the current line.
 
-    Otherwise return -1 and do nothing.
+    Returns the length of the keyword, which may be zero, and sets `keyword` to its start.
+    The cursor is moved past the keyword and any spaces after it.
  */
-static int check_keyword(struct BDFLoader* loader, const char* keyword) {
-  ptrdiff_t key_length = (ptrdiff_t)strlen(keyword);
-  if (loader->end - loader->cursor < key_length) {
-    return -1;
-  }
-  if (strncmp(loader->cursor, keyword, (size_t)key_length) != 0) {
-    return -1;  // No match.
+static ptrdiff_t read_keyword(struct BDFLoader* loader, const char** keyword) {
+  const char* cursor = loader->cursor;
+  *keyword = cursor;
+  while (cursor < loader->end && *cursor != ' ' && *cursor != '\r' && *cursor != '\n') {
+    ++cursor;
   }
-  if (!(loader->end - loader->cursor == key_length || loader->cursor[key_length] == ' ' ||
-        loader->cursor[key_length] == '\r' || loader->cursor[key_length] == '\n')) {
-    return -1;
-  }
-  loader->cursor += key_length;
-  while (loader->cursor < loader->end && loader->cursor[0] == ' ') {
-    ++loader->cursor;
+  const ptrdiff_t length = cursor - *keyword;
+  while (cursor < loader->end && *cursor == ' ') {
+    ++cursor;
   }
-  return 0;
-}
-/***************************************************************************
-    Move the cursor pass any newlines it is currently at.  Return the number of newlines passed.
- */
-static int bdf_handle_newlines(struct BDFLoader* loader) {
-  int newlines_count = 0;
-  while (loader->cursor < loader->end) {
-    if (loader->cursor[0] == '\r') {
-      ++loader->cursor;
-      if (loader->cursor < loader->end && loader->cursor[0] == '\n') {
-        ++loader->cursor;
-      }
-    } else if (loader->cursor[0] == '\n') {
-      ++loader->cursor;
-    } else {
-      break;  // No more newlines at cursor.
-    }
-    ++newlines_count;
-  }
-  loader->line_number += newlines_count;
-  return newlines_count;
+  loader->cursor = cursor;
+  return length;
 }
 /**
     Advance the cursor to the next line.  Returns -1 on error.
  */
 static int goto_next_line(struct BDFLoader* loader) {
-  while (loader->cursor < loader->end) {
-    if (bdf_handle_newlines(loader) > 0) {
-      return 0;
+  const char* cursor = loader->cursor;
+  while (cursor < loader->end && *cursor != '\r' && *cursor != '\n') {
+    ++cursor;
+  }
+  if (cursor == loader->end) {
+    loader->cursor = cursor;
+    TCOD_set_errorv("Unexpected end of data stream.");
+    return -1;
+  }
+  // Pass any newlines.  "\r\n" counts as one newline.
+  while (cursor < loader->end) {
+    if (*cursor == '\r') {
+      ++cursor;
+      if (cursor < loader->end && *cursor == '\n') {
+        ++cursor;
+      }
+    } else if (*cursor == '\n') {
+      ++cursor;
+    } else {
+      break;  // No more newlines at cursor.
     }
-    ++loader->cursor;
+    ++loader->line_number;
   }
-  TCOD_set_errorv("Unexpected end of data stream.");
-  return -1;
+  loader->cursor = cursor;
+  return 0;
 }
 /**
-    Return a number under the cursor and advance.
+    Return a decimal number under the cursor and advance.
 
-    This doesn't have any error handing currently.
+    This doesn't have any error handing currently, a missing number is read as zero.
  */
 static int read_next_int(struct BDFLoader* loader) {
-  long int number = strtol(loader->cursor, (char**)&loader->cursor, 0);
-  return (int)number;
+  const char* cursor = loader->cursor;
+  while (cursor < loader->end && *cursor == ' ') {
+    ++cursor;
+  }
+  const bool negative = cursor < loader->end && *cursor == '-';
+  if (cursor < loader->end && (*cursor == '-' || *cursor == '+')) {
+    ++cursor;
+  }
+  int64_t number = 0;
+  while (cursor < loader->end && '0' <= *cursor && *cursor <= '9') {
+    if (number <= INT_MAX) {
+      number = number * 10 + (*cursor - '0');
+    }
+    ++cursor;
+  }
+  loader->cursor = cursor;
+  if (number > INT_MAX) number = INT_MAX;
+  return (int)(negative ? -number : number);
 }
 /**
-    Read the next two hexadecimal numbers in a bitmap line.
-
-    Returns a byte in the uint8_t range or -1 on failure.
+    Return true if the glyph for `codepoint` should be loaded.
  */
-static int read_next_bitmap_byte(struct BDFLoader* loader) {
-  if (loader->end - loader->cursor < 2) {
-    return -1;
-  }
-  // Fetch and verify the hexadecimal data so that strtoul can't fail.
-  char hexstring[3] = {loader->cursor[0], loader->cursor[1], 0};
-  if (!isxdigit((int)hexstring[0]) || !isxdigit((int)hexstring[1])) {
-    TCOD_set_errorvf("Failed to unpack bitmap on line %d", loader->line_number);
-    return -1;
-  }
-  loader->cursor += 2;
-  return (int)strtoul(hexstring, NULL, 16);
+static bool is_codepoint_wanted(const struct BDFLoader* loader, int codepoint) {
+  if (codepoint < 0) return false;  // Ignore "ENCODING -1".
+  if (!loader->subset) return true;
+  if (codepoint > loader->subset_max) return false;
+  return (loader->subset[codepoint / 8] >> (codepoint % 8)) & 1;
 }
 /**
     Handle BITMAP, parse the bitmap data into a tile for the tileset.
  */
-static int parse_bitmap(struct BDFLoader* loader, int codepoint, struct BBox* glyph_bbox) {
-  int offset_x = -loader->bbox.xoffset + glyph_bbox->xoffset;
-  int offset_y = (loader->bbox.height - glyph_bbox->height + loader->bbox.yoffset - glyph_bbox->yoffset);
-  TCOD_ColorRGBA* pixels = malloc(loader->tileset->tile_length * sizeof(*pixels));
+static int parse_bitmap(struct BDFLoader* loader, int codepoint, const struct BBox* glyph_bbox) {
+  const int tile_width = loader->tileset->tile_width;
+  const int tile_height = loader->tileset->tile_height;
+  const int offset_x = -loader->bbox.xoffset + glyph_bbox->xoffset;
+  const int offset_y = (loader->bbox.height - glyph_bbox->height + loader->bbox.yoffset - glyph_bbox->yoffset);
+  // The glyph columns which land inside of the tile.
+  const int begin_x = offset_x < 0 ? -offset_x : 0;
+  const int end_x = glyph_bbox->width < tile_width - offset_x ? glyph_bbox->width : tile_width - offset_x;
+  const ptrdiff_t row_bytes = ((ptrdiff_t)glyph_bbox->width + 7) / 8;
+  TCOD_ColorRGBA* pixels = loader->pixels;
   for (int i = 0; i < loader->tileset->tile_length; ++i) {
     pixels[i] = (TCOD_ColorRGBA){255, 255, 255, 0};
   }
   for (int bitmap_y = 0; bitmap_y < glyph_bbox->height; ++bitmap_y) {
-    goto_next_line(loader);
-    int bitmask = 0;
-    for (int bitmap_x = 0; bitmap_x < glyph_bbox->width; ++bitmap_x) {
-      if (bitmap_x % 8 == 0) {
-        bitmask = read_next_bitmap_byte(loader);
-        if (bitmask < 0) {
-          free(pixels);
-          return -1;
-        }
+    if (goto_next_line(loader) < 0) return -1;
+    const unsigned char* row = (const unsigned char*)loader->cursor;
+    if (loader->end - loader->cursor < row_bytes * 2) {
+      TCOD_set_errorvf("Failed to unpack bitmap on line %d", loader->line_number);
+      return -1;
+    }
+    loader->cursor += row_bytes * 2;
+    const int target_y = bitmap_y + offset_y;
+    if (target_y < 0 || target_y >= tile_height) continue;
+    TCOD_ColorRGBA* __restrict row_out = pixels + target_y * tile_width;
+    for (ptrdiff_t byte_i = 0; byte_i < row_bytes; ++byte_i) {
+      const int high = hex_digit_table[row[byte_i * 2]];
+      const int low = hex_digit_table[row[byte_i * 2 + 1]];
+      if (!(high & low & 0x10)) {
+        TCOD_set_errorvf("Failed to unpack bitmap on line %d", loader->line_number);
+        return -1;
       }
-      bool bit = bitmask & (1 << (7 - bitmap_x % 8));
-      int target_x = bitmap_x + offset_x;
-      int target_y = bitmap_y + offset_y;
-      if (0 <= target_x && target_x < loader->tileset->tile_width && 0 <= target_y &&
-          target_y < loader->tileset->tile_height) {
-        pixels[target_y * loader->tileset->tile_width + target_x].a = bit * 255;
+      const int bits = ((high & 0xF) << 4) | (low & 0xF);
+      const int byte_x = (int)byte_i * 8;
+      const int x_min = begin_x > byte_x ? begin_x : byte_x;
+      const int x_max = end_x < byte_x + 8 ? end_x : byte_x + 8;
+      for (int bitmap_x = x_min; bitmap_x < x_max; ++bitmap_x) {
+        row_out[offset_x + bitmap_x].a = (uint8_t)(((bits >> (7 - (bitmap_x - byte_x))) & 1) * 255);
       }
     }
   }
-  int err = 0;
-  if (codepoint >= 0) {  // Ignore "ENCODING -1".
-    err = TCOD_tileset_set_tile_(loader->tileset, codepoint, pixels);
+  return TCOD_tileset_set_tile_(loader->tileset, codepoint, pixels);
+}
+/**
+    Move the cursor to the ENDCHAR line of the current glyph without parsing it.
+ */
+static int skip_char(struct BDFLoader* loader) {
+  while (goto_next_line(loader) == 0) {
+    if (loader->end - loader->cursor >= 7 && memcmp(loader->cursor, "ENDCHAR", 7) == 0) {
+      return 0;
+    }
   }
-  free(pixels);
-  return err;
+  return -1;
 }
 /**
     Handle STARCHAR.
@@ -202,30 +239,34 @@ static int parse_char(struct BDFLoader* loader) {
   int codepoint = 0;
   struct BBox glyph_bbox = {0, 0, 0, 0};
   while (goto_next_line(loader) == 0) {
-    if (check_keyword(loader, "ENDCHAR") == 0) {
+    const char* keyword;
+    const ptrdiff_t length = read_keyword(loader, &keyword);
+    if (IS_KEYWORD(keyword, length, "ENDCHAR")) {
       return 0;
-    } else if (check_keyword(loader, "ENCODING") == 0) {
+    } else if (IS_KEYWORD(keyword, length, "ENCODING")) {
       codepoint = read_next_int(loader);
-    } else if (check_keyword(loader, "BBX") == 0) {
+      if (!is_codepoint_wanted(loader, codepoint)) {
+        return skip_char(loader);
+      }
+    } else if (IS_KEYWORD(keyword, length, "BBX")) {
       glyph_bbox.width = read_next_int(loader);
       glyph_bbox.height = read_next_int(loader);
       glyph_bbox.xoffset = read_next_int(loader);
       glyph_bbox.yoffset = read_next_int(loader);
-    } else if (check_keyword(loader, "BITMAP") == 0) {
+      if (glyph_bbox.width < 0 || glyph_bbox.height < 0) {
+        TCOD_set_errorvf("Invalid BBX size on line %d", loader->line_number + 1);
+        return -1;
+      }
+    } else if (IS_KEYWORD(keyword, length, "BITMAP")) {
       if (parse_bitmap(loader, codepoint, &glyph_bbox) < 0) {
         return -1;
       }
-    } else if (check_keyword(loader, "SWIDTH") == 0) {
-      // Ignore.
-    } else if (check_keyword(loader, "DWIDTH") == 0) {
-      // Ignore.
-    } else if (check_keyword(loader, "SWIDTH1") == 0) {
-      // Ignore.
-    } else if (check_keyword(loader, "DWIDTH1") == 0) {
-      // Ignore.
-    } else if (check_keyword(loader, "VVECTOR") == 0) {
+    } else if (
+        IS_KEYWORD(keyword, length, "SWIDTH") || IS_KEYWORD(keyword, length, "DWIDTH") ||
+        IS_KEYWORD(keyword, length, "SWIDTH1") || IS_KEYWORD(keyword, length, "DWIDTH1") ||
+        IS_KEYWORD(keyword, length, "VVECTOR")) {
       // Ignore.
-    } else if (check_keyword(loader, "") == 0) {  // Ignore empty lines.
+    } else if (length == 0) {  // Ignore empty lines.
     } else {
       TCOD_set_errorvf("Unknown keyword on line %d", loader->line_number + 1);
       return -1;
@@ -245,13 +286,15 @@ static int parse_bdf_chars(struct BDFLoader* loader) {
   int font_glyphs = read_next_int(loader);
   int processed_glyphs = 0;
   while (goto_next_line(loader) == 0) {
-    if (check_keyword(loader, "ENDFONT") == 0) {
+    const char* keyword;
+    const ptrdiff_t length = read_keyword(loader, &keyword);
+    if (IS_KEYWORD(keyword, length, "ENDFONT")) {
       if (font_glyphs != processed_glyphs) {
         TCOD_set_errorvf("Expected %d glyphs, but processed %d.", font_glyphs, processed_glyphs);
         return -1;
       }
       return 0;
-    } else if (check_keyword(loader, "STARTCHAR") == 0) {
+    } else if (IS_KEYWORD(keyword, length, "STARTCHAR")) {
       if (parse_char(loader) < 0) {
         return -1;
       }
@@ -268,21 +311,20 @@ static int parse_bdf_chars(struct BDFLoader* loader) {
     Begins parsing the BDF data.
  */
 static int parse_bdf(struct BDFLoader* loader) {
-  bdf_handle_newlines(loader);
-  if (check_keyword(loader, "STARTFONT") < 0) {
+  // Skip leading newlines.
+  while (loader->cursor < loader->end && (*loader->cursor == '\r' || *loader->cursor == '\n')) {
+    if (*loader->cursor == '\n') ++loader->line_number;
+    ++loader->cursor;
+  }
+  const char* keyword;
+  ptrdiff_t length = read_keyword(loader, &keyword);
+  if (!IS_KEYWORD(keyword, length, "STARTFONT")) {
     TCOD_set_errorv("BDF files must begin with the STARTFONT keyword.");
     return -1;
   }
   while (goto_next_line(loader) == 0) {
-    if (check_keyword(loader, "COMMENT") == 0) {
-      // Ignore.
-    } else if (check_keyword(loader, "CONTENTVERSION") == 0) {
-      // Ignore.
-    } else if (check_keyword(loader, "FONT") == 0) {
-      // Ignore.
-    } else if (check_keyword(loader, "SIZE") == 0) {
-      // Ignore.
-    } else if (check_keyword(loader, "FONTBOUNDINGBOX") == 0) {
+    length = read_keyword(loader, &keyword);
+    if (IS_KEYWORD(keyword, length, "FONTBOUNDINGBOX")) {
       if (loader->tileset) {
         TCOD_set_errorv("Invalid multiple FONTBOUNDINGBOX keywords found.");
         return -1;
@@ -295,29 +337,31 @@ static int parse_bdf(struct BDFLoader* loader) {
       if (!loader->tileset) {
         return -1;
       }
-    } else if (check_keyword(loader, "METRICSSET") == 0) {
-      // Ignore.
-    } else if (check_keyword(loader, "STARTPROPERTIES") == 0) {
+      const int tile_length = loader->tileset->tile_length;
+      loader->pixels = malloc(sizeof(*loader->pixels) * (tile_length ? tile_length : 1));
+      if (!loader->pixels) {
+        TCOD_set_errorv("Out of memory.");
+        return -1;
+      }
+    } else if (IS_KEYWORD(keyword, length, "STARTPROPERTIES")) {
       int n_properties = read_next_int(loader);
       goto_next_line(loader);
       while (n_properties--) {
         goto_next_line(loader);
       }
-      if (check_keyword(loader, "ENDPROPERTIES") < 0) {
+      length = read_keyword(loader, &keyword);
+      if (!IS_KEYWORD(keyword, length, "ENDPROPERTIES")) {
         TCOD_set_errorv("Incorrect number of properties.");
         return -1;
       }
-    } else if (check_keyword(loader, "CHARS") == 0) {
+    } else if (IS_KEYWORD(keyword, length, "CHARS")) {
       return parse_bdf_chars(loader);
-    } else if (check_keyword(loader, "SWIDTH") == 0) {
-      // Ignore.
-    } else if (check_keyword(loader, "DWIDTH") == 0) {
-      // Ignore.
-    } else if (check_keyword(loader, "SWIDTH1") == 0) {
-      // Ignore.
-    } else if (check_keyword(loader, "DWIDTH1") == 0) {
-      // Ignore.
-    } else if (check_keyword(loader, "VVECTOR") == 0) {
+    } else if (
+        IS_KEYWORD(keyword, length, "COMMENT") || IS_KEYWORD(keyword, length, "CONTENTVERSION") ||
+        IS_KEYWORD(keyword, length, "FONT") || IS_KEYWORD(keyword, length, "SIZE") ||
+        IS_KEYWORD(keyword, length, "METRICSSET") || IS_KEYWORD(keyword, length, "SWIDTH") ||
+        IS_KEYWORD(keyword, length, "DWIDTH") || IS_KEYWORD(keyword, length, "SWIDTH1") ||
+        IS_KEYWORD(keyword, length, "DWIDTH1") || IS_KEYWORD(keyword, length, "VVECTOR")) {
       // Ignore.
     } else {
       TCOD_set_errorvf("Unknown keyword on line %d", loader->line_number);
@@ -328,16 +372,48 @@ static int parse_bdf(struct BDFLoader* loader) {
   return -1;
 }
 TCOD_Tileset* TCOD_load_bdf_memory(int size, const unsigned char* buffer) {
+  return TCOD_load_bdf_memory_subset(size, buffer, 0, NULL);
+}
+TCOD_Tileset* TCOD_load_bdf_memory_subset(
+    int size, const unsigned char* buffer, int codepoints_count, const int* codepoints) {
+  if (!buffer && size) {
+    TCOD_set_errorv("Buffer must not be NULL.");
+    return NULL;
+  }
+  if (codepoints_count < 0 || (!codepoints && codepoints_count)) {
+    TCOD_set_errorv("Invalid codepoints array.");
+    return NULL;
+  }
+  unsigned char* subset = NULL;
+  int subset_max = -1;
+  if (codepoints) {
+    for (int i = 0; i < codepoints_count; ++i) {
+      if (codepoints[i] > subset_max) subset_max = codepoints[i];
+    }
+    subset = calloc((size_t)(subset_max < 0 ? 0 : subset_max) / 8 + 1, 1);
+    if (!subset) {
+      TCOD_set_errorv("Out of memory.");
+      return NULL;
+    }
+    for (int i = 0; i < codepoints_count; ++i) {
+      if (codepoints[i] >= 0) subset[codepoints[i] / 8] |= (unsigned char)(1 << (codepoints[i] % 8));
+    }
+  }
   struct BDFLoader loader = {
       .buffer = (const char*)buffer,
       .end = (const char*)buffer + size,
       .cursor = (const char*)buffer,
       .line_number = 0,
       .tileset = NULL,
+      .subset = subset,
+      .subset_max = subset_max,
+      .pixels = NULL,
   };
   if (parse_bdf(&loader) < 0) {
     TCOD_tileset_delete(loader.tileset);
     loader.tileset = NULL;
   }
+  free(loader.pixels);
+  free(subset);
   return loader.tileset;
 }
@@ -65,6 +65,35 @@ TCODLIB_API TCOD_NODISCARD TCOD_Tileset* TCOD_load_bdf(const char* path);
     \endrst
  */
 TCODLIB_API TCOD_NODISCARD TCOD_Tileset* TCOD_load_bdf_memory(int size, const unsigned char* buffer);
+/**
+    Load only the glyphs for `codepoints` from a BDF font file.
+
+    `codepoints_count` is the length of the `codepoints` array.
+    Glyphs for other codepoints are skipped without decoding their bitmaps, which is much faster for large Unicode
+    fonts when only a few scripts are needed.
+
+    May return NULL on failure.  See `TCOD_get_error` for the error message.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCODLIB_API TCOD_NODISCARD TCOD_Tileset* TCOD_load_bdf_subset(
+    const char* path, int codepoints_count, const int* codepoints);
+/**
+    Load only the glyphs for `codepoints` from BDF data in memory.
+
+    The data is parsed in place and is never copied, so `buffer` may be a memory mapped file.
+    If `codepoints` is NULL then every glyph is loaded, the same as `TCOD_load_bdf_memory`.
+
+    May return NULL on failure.  See `TCOD_get_error` for the error message.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCODLIB_API TCOD_NODISCARD TCOD_Tileset* TCOD_load_bdf_memory_subset(
+    int size, const unsigned char* buffer, int codepoints_count, const int* codepoints);
 /// @}
 #ifdef __cplusplus
 }  // extern "C"
@@ -33,6 +33,7 @@
 #define LIBTCOD_TILESET_BDF_HPP_
 
 #include <filesystem>
+#include <vector>
 
 #include "error.hpp"
 #include "tileset.hpp"
@@ -57,6 +58,24 @@ inline auto load_bdf(const std::filesystem::path& path) -> TilesetPtr {
   if (!tileset) throw std::runtime_error(TCOD_get_error());
   return tileset;
 }
+/**
+    Load only the glyphs for `codepoints` from a BDF font file.
+
+    Will throw an exception on a missing or corrupt file.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_NODISCARD
+inline auto load_bdf(const std::filesystem::path& path, const std::vector<int>& codepoints) -> TilesetPtr {
+  tcod::check_path(path);
+  const int no_codepoints = 0;  // An empty vector may have a NULL data pointer, which would load every glyph.
+  const int* codepoints_ptr = codepoints.empty() ? &no_codepoints : codepoints.data();
+  TilesetPtr tileset{TCOD_load_bdf_subset(path.string().c_str(), static_cast<int>(codepoints.size()), codepoints_ptr)};
+  if (!tileset) throw std::runtime_error(TCOD_get_error());
+  return tileset;
+}
 /// @}
 }  // namespace tcod
 #endif  // LIBTCOD_TILESET_BDF_HPP_
@@ -0,0 +1,228 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice and the libtcod contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "tileset_cache.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "utility.h"
+
+#define TCOD_TILESET_CACHE_VERSION 1
+#define TCOD_TILESET_CACHE_BYTE_ORDER 0x01020304  // Caches are only loaded on machines with the same byte order.
+static const char TCOD_TILESET_CACHE_MAGIC[8] = "TCODTSC";
+/**
+    The header of a cache file.
+
+    It is followed by `tiles_count * tile_width * tile_height` RGBA pixels and then `character_map_pages` pages of
+    the character map, each being a 32-bit page index followed by `TCOD_CHARMAP_PAGE_LENGTH_` 32-bit tile indexes.
+    Pages with no assigned codepoints are not stored.  The fields are ordered so that the header has no padding.
+ */
+struct TilesetCacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t source_hash;
+  int32_t tile_width;
+  int32_t tile_height;
+  int32_t tiles_count;
+  int32_t character_map_pages;
+  int32_t virtual_columns;
+  int32_t reserved;
+};
+/**
+    Return true if any codepoint on `page` is assigned to a tile.
+ */
+static bool is_page_used(const int* page) {
+  for (int i = 0; i < TCOD_CHARMAP_PAGE_LENGTH_; ++i) {
+    if (page[i]) return true;
+  }
+  return false;
+}
+/**
+    Return the 64-bit FNV-1a hash of the file at `path` in `hash_out`.
+ */
+static TCOD_Error hash_file(const char* path, uint64_t* hash_out) {
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    return TCOD_set_errorvf("Could not open file:\n%s", path);
+  }
+  uint64_t hash = UINT64_C(0xcbf29ce484222325);
+  unsigned char buffer[4096];
+  size_t length;
+  while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    for (size_t i = 0; i < length; ++i) {
+      hash = (hash ^ buffer[i]) * UINT64_C(0x100000001b3);
+    }
+  }
+  const bool failed = ferror(file) != 0;
+  fclose(file);
+  if (failed) {
+    return TCOD_set_errorvf("Error while reading file:\n%s", path);
+  }
+  *hash_out = hash;
+  return TCOD_E_OK;
+}
+TCOD_Error TCOD_tileset_save_cache(const TCOD_Tileset* __restrict tileset, const char* path, const char* source_path) {
+  if (!tileset) {
+    TCOD_set_errorv("Tileset argument must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (!path) {
+    TCOD_set_errorv("Path must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  struct TilesetCacheHeader header = {
+      .version = TCOD_TILESET_CACHE_VERSION,
+      .byte_order = TCOD_TILESET_CACHE_BYTE_ORDER,
+      .tile_width = tileset->tile_width,
+      .tile_height = tileset->tile_height,
+      .tiles_count = tileset->tiles_count,
+      .virtual_columns = tileset->virtual_columns,
+  };
+  memcpy(header.magic, TCOD_TILESET_CACHE_MAGIC, sizeof(header.magic));
+  const int pages_total = tileset->character_map_length / TCOD_CHARMAP_PAGE_LENGTH_;
+  for (int i = 0; i < pages_total; ++i) {
+    if (is_page_used(tileset->character_map_pages[i])) ++header.character_map_pages;
+  }
+  if (source_path) {
+    const TCOD_Error err = hash_file(source_path, &header.source_hash);
+    if (err < 0) return err;
+  }
+  FILE* file = fopen(path, "wb");
+  if (!file) {
+    return TCOD_set_errorvf("Could not open file for writing:\n%s", path);
+  }
+  const size_t pixels_count = (size_t)tileset->tiles_count * tileset->tile_length;
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+  ok = ok && (!pixels_count || fwrite(tileset->pixels, sizeof(*tileset->pixels), pixels_count, file) == pixels_count);
+  for (int32_t i = 0; ok && i < pages_total; ++i) {
+    const int* page = tileset->character_map_pages[i];
+    if (!is_page_used(page)) continue;
+    ok = fwrite(&i, sizeof(i), 1, file) == 1 &&
+         fwrite(page, sizeof(int32_t), TCOD_CHARMAP_PAGE_LENGTH_, file) == TCOD_CHARMAP_PAGE_LENGTH_;
+  }
+  ok = (fclose(file) == 0) && ok;
+  if (!ok) {
+    remove(path);  // Don't leave a truncated cache behind.
+    return TCOD_set_errorvf("Error while writing file:\n%s", path);
+  }
+  return TCOD_E_OK;
+}
+/**
+    Read the tileset from an open cache file.  Returns NULL on error.
+ */
+static TCOD_Tileset* read_cache(FILE* file, const char* path, const char* source_path) {
+  struct TilesetCacheHeader header;
+  if (fread(&header, sizeof(header), 1, file) != 1 ||
+      memcmp(header.magic, TCOD_TILESET_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != TCOD_TILESET_CACHE_VERSION || header.byte_order != TCOD_TILESET_CACHE_BYTE_ORDER) {
+    TCOD_set_errorvf("Not a tileset cache for this version of libtcod:\n%s", path);
+    return NULL;
+  }
+  if (header.tile_width < 0 || header.tile_height < 0 || header.tiles_count < 0 || header.character_map_pages < 0 ||
+      header.virtual_columns < 1 ||
+      (int64_t)header.tile_width * header.tile_height * MAX(header.tiles_count, 1) > INT32_MAX) {
+    TCOD_set_errorvf("Tileset cache has an invalid header:\n%s", path);
+    return NULL;
+  }
+  if (source_path) {
+    uint64_t source_hash;
+    if (hash_file(source_path, &source_hash) < 0) return NULL;
+    if (source_hash != header.source_hash) {
+      TCOD_set_errorvf("Tileset cache is out of date:\n%s", path);
+      return NULL;
+    }
+  }
+  TCOD_Tileset* tileset = TCOD_tileset_new(header.tile_width, header.tile_height);
+  if (!tileset) {
+    TCOD_set_errorv("Out of memory.");
+    return NULL;
+  }
+  tileset->virtual_columns = header.virtual_columns;
+  const size_t pixels_count = (size_t)header.tiles_count * tileset->tile_length;
+  // Allocated exactly and filled straight from the file, the tileset grows it as usual if tiles are added later.
+  tileset->pixels = malloc(sizeof(*tileset->pixels) * (pixels_count ? pixels_count : 1));
+  if (!tileset->pixels) {
+    TCOD_set_errorv("Out of memory.");
+    TCOD_tileset_delete(tileset);
+    return NULL;
+  }
+  tileset->tiles_capacity = tileset->tiles_count = header.tiles_count;
+  if (fread(tileset->pixels, sizeof(*tileset->pixels), pixels_count, file) != pixels_count) {
+    TCOD_set_errorvf("Tileset cache is truncated:\n%s", path);
+    TCOD_tileset_delete(tileset);
+    return NULL;
+  }
+  for (int32_t i = 0; i < header.character_map_pages; ++i) {
+    int32_t page_index;
+    int32_t page[TCOD_CHARMAP_PAGE_LENGTH_];
+    if (fread(&page_index, sizeof(page_index), 1, file) != 1 ||
+        fread(page, sizeof(*page), TCOD_CHARMAP_PAGE_LENGTH_, file) != TCOD_CHARMAP_PAGE_LENGTH_) {
+      TCOD_set_errorvf("Tileset cache is truncated:\n%s", path);
+      TCOD_tileset_delete(tileset);
+      return NULL;
+    }
+    if (page_index < 0 || page_index > INT32_MAX / TCOD_CHARMAP_PAGE_LENGTH_ - 1) {
+      TCOD_set_errorvf("Tileset cache has an invalid character map:\n%s", path);
+      TCOD_tileset_delete(tileset);
+      return NULL;
+    }
+    for (int j = 0; j < TCOD_CHARMAP_PAGE_LENGTH_; ++j) {
+      if (!page[j]) continue;
+      // Also rejects tile indexes which are out of bounds.
+      if (TCOD_tileset_assign_tile(tileset, page[j], page_index * TCOD_CHARMAP_PAGE_LENGTH_ + j) < 0) {
+        TCOD_set_errorvf("Tileset cache has an invalid character map:\n%s", path);
+        TCOD_tileset_delete(tileset);
+        return NULL;
+      }
+    }
+  }
+  return tileset;
+}
+TCOD_Tileset* TCOD_tileset_load_cache(const char* path, const char* source_path) {
+  if (!path) {
+    TCOD_set_errorv("Path must not be NULL.");
+    return NULL;
+  }
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    TCOD_set_errorvf("Could not open file:\n%s", path);
+    return NULL;
+  }
+  TCOD_Tileset* tileset = read_cache(file, path, source_path);
+  fclose(file);
+  return tileset;
+}
@@ -0,0 +1,76 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice and the libtcod contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LIBTCOD_TILESET_CACHE_H_
+#define LIBTCOD_TILESET_CACHE_H_
+
+#include "config.h"
+#include "error.h"
+#include "tileset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+/**
+    Save the tiles and character map of `tileset` to a binary cache file at `path`.
+
+    `source_path` is the file the tileset was loaded from, such as a PNG, BDF, or TrueType font.
+    A hash of its contents is stored so that `TCOD_tileset_load_cache` can reject the cache once the source changes.
+    `source_path` can be NULL to skip this check.
+
+    The cache does not record how the source was loaded, use a different cache path for each set of load parameters.
+    Only tiles which are currently loaded are saved, tiles of lazily loaded tilesets are not loaded by this function.
+
+    Returns a negative value on error.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_NODISCARD TCOD_Error
+TCOD_tileset_save_cache(const TCOD_Tileset* __restrict tileset, const char* path, const char* source_path);
+/**
+    Load a tileset from a binary cache file made by `TCOD_tileset_save_cache`.
+
+    Tiles are read directly into the new tileset without decoding.
+    If `source_path` is not NULL then the cache is only loaded if it was saved from a source with the same contents.
+
+    Returns NULL if the cache is missing, out of date, or invalid.  See `TCOD_get_error` for the reason.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_NODISCARD TCOD_Tileset* TCOD_tileset_load_cache(const char* path, const char* source_path);
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+#endif  // LIBTCOD_TILESET_CACHE_H_
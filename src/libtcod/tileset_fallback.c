@@ -47,9 +47,9 @@ TCOD_Tileset* TCOD_tileset_load_fallback_font_(int tile_width, int tile_height)
   char path[4096] = "";
   strncpy(path, sys_root, sizeof(path) - 1);
   strncat(path, filename, sizeof(path) - 1 - strlen(path));
-  return TCOD_load_truetype_font_(path, tile_width, tile_height);
+  return TCOD_load_truetype_font_lazy_(path, tile_width, tile_height);
 #elif defined(__APPLE__)  // MacOS.
-  return TCOD_load_truetype_font_("/System/Library/Fonts/SFNSMono.ttf", tile_width, tile_height);
+  return TCOD_load_truetype_font_lazy_("/System/Library/Fonts/SFNSMono.ttf", tile_width, tile_height);
 #elif defined(__unix__)  // Linux
   FILE* pipe = popen("fc-match --format=%{file} monospace", "r");
   char path[4096] = "";
@@ -62,7 +62,7 @@ TCOD_Tileset* TCOD_tileset_load_fallback_font_(int tile_width, int tile_height)
     TCOD_set_errorv("Could not get a font from fc-match.");
     return NULL;
   }
-  return TCOD_load_truetype_font_(path, tile_width, tile_height);
+  return TCOD_load_truetype_font_lazy_(path, tile_width, tile_height);
 #else
   return NULL;
   // throw std::runtime_error("Fallback font not supported for this OS.");
@@ -34,37 +34,224 @@
 #ifndef NO_SDL
 #include <SDL.h>
 #endif  // NO_SDL
+
+#include "libtcod_int.h"
+#include "utility.h"
+/**
+    Divide `x` by 255 rounding down.  Exact for `0 <= x <= 65025`, the range of any two channels multiplied together.
+
+    Staying in 16 bits lets vectorized code fit twice as many lanes per register.
+ */
+static inline uint16_t div255(uint16_t x) { return (uint16_t)((uint16_t)(x + 1 + (x >> 8)) >> 8); }
 /**
     Render a single tile.
+
+    Opaque backgrounds, which are the common case, use a branch-free integer kernel which compilers can vectorize.
+    The output matches `TCOD_color_alpha_blend` exactly.
  */
 static void render_tile(
     const TCOD_Tileset* __restrict tileset,
     const struct TCOD_ConsoleTile* __restrict tile,
     struct TCOD_ColorRGBA* __restrict out_rgba,
     int stride) {
-  const TCOD_ColorRGBA* graphic = TCOD_tileset_get_tile(tileset, tile->ch);
+  const TCOD_ColorRGBA* __restrict graphic = TCOD_tileset_get_tile(tileset, tile->ch);
+  if (!graphic) {
+    for (int y = 0; y < tileset->tile_height; ++y) {
+      TCOD_ColorRGBA* __restrict out = (TCOD_ColorRGBA*)((char*)out_rgba + stride * y);
+      for (int x = 0; x < tileset->tile_width; ++x) out[x] = tile->bg;
+    }
+    return;
+  }
+  if (tile->bg.a == 255) {
+    // With an opaque destination the blended alpha is always 255 and the blend reduces to a weighted sum.
+    const uint16_t fg_r = tile->fg.r;
+    const uint16_t fg_g = tile->fg.g;
+    const uint16_t fg_b = tile->fg.b;
+    const uint16_t fg_a = tile->fg.a;
+    const uint16_t bg_r = tile->bg.r;
+    const uint16_t bg_g = tile->bg.g;
+    const uint16_t bg_b = tile->bg.b;
+    for (int y = 0; y < tileset->tile_height; ++y) {
+      const TCOD_ColorRGBA* __restrict in = graphic + y * tileset->tile_width;
+      TCOD_ColorRGBA* __restrict out = (TCOD_ColorRGBA*)((char*)out_rgba + stride * y);
+      for (int x = 0; x < tileset->tile_width; ++x) {
+        const uint16_t src_a = div255((uint16_t)(fg_a * in[x].a));
+        const uint16_t dst_a = (uint16_t)(255 - src_a);
+        out[x].r = (uint8_t)div255((uint16_t)(div255((uint16_t)(fg_r * in[x].r)) * src_a + bg_r * dst_a));
+        out[x].g = (uint8_t)div255((uint16_t)(div255((uint16_t)(fg_g * in[x].g)) * src_a + bg_g * dst_a));
+        out[x].b = (uint8_t)div255((uint16_t)(div255((uint16_t)(fg_b * in[x].b)) * src_a + bg_b * dst_a));
+        out[x].a = 255;
+      }
+    }
+    return;
+  }
   for (int y = 0; y < tileset->tile_height; ++y) {
     TCOD_ColorRGBA* out = (TCOD_ColorRGBA*)((char*)out_rgba + stride * y);
     for (int x = 0; x < tileset->tile_width; ++x) {
-      if (graphic) {
-        // Multiply the foreground and tileset colors, then blend with bg.
-        struct TCOD_ColorRGBA rgba = tile->bg;
-        int graphic_i = y * tileset->tile_width + x;
-        struct TCOD_ColorRGBA fg = {
-            tile->fg.r * graphic[graphic_i].r / 255,
-            tile->fg.g * graphic[graphic_i].g / 255,
-            tile->fg.b * graphic[graphic_i].b / 255,
-            tile->fg.a * graphic[graphic_i].a / 255,
-        };
-        TCOD_color_alpha_blend(&rgba, &fg);
-        out[x] = rgba;
-      } else {
-        out[x] = tile->bg;
+      // Multiply the foreground and tileset colors, then blend with bg.
+      struct TCOD_ColorRGBA rgba = tile->bg;
+      int graphic_i = y * tileset->tile_width + x;
+      struct TCOD_ColorRGBA fg = {
+          (uint8_t)div255((uint16_t)(tile->fg.r * graphic[graphic_i].r)),
+          (uint8_t)div255((uint16_t)(tile->fg.g * graphic[graphic_i].g)),
+          (uint8_t)div255((uint16_t)(tile->fg.b * graphic[graphic_i].b)),
+          (uint8_t)div255((uint16_t)(tile->fg.a * graphic[graphic_i].a)),
+      };
+      TCOD_color_alpha_blend(&rgba, &fg);
+      out[x] = rgba;
+    }
+  }
+}
+/// Return true if `a` and `b` would render the same.
+static bool tiles_equal(const struct TCOD_ConsoleTile* __restrict a, const struct TCOD_ConsoleTile* __restrict b) {
+  return a->ch == b->ch && a->fg.r == b->fg.r && a->fg.g == b->fg.g && a->fg.b == b->fg.b && a->fg.a == b->fg.a &&
+         a->bg.r == b->bg.r && a->bg.g == b->bg.g && a->bg.b == b->bg.b && a->bg.a == b->bg.a;
+}
+/**
+    A horizontal band of console rows rendered by a single thread.
+ */
+struct RenderBand {
+  const TCOD_Tileset* tileset;
+  const TCOD_Console* console;
+  TCOD_Console* cache;  // May be NULL.
+  TCOD_ColorRGBA* out_rgba;
+  int stride;
+  int y_begin;
+  int y_end;
+};
+/**
+    Render the rows of `band`.  Bands never share console rows so they can be rendered concurrently.
+ */
+static void render_band(const struct RenderBand* __restrict band) {
+  const TCOD_Tileset* tileset = band->tileset;
+  const TCOD_Console* console = band->console;
+  TCOD_Console* cache_console = band->cache;
+  for (int console_y = band->y_begin; console_y < band->y_end; ++console_y) {
+    const TCOD_ConsoleDirtySpan span = TCOD_console_get_redraw_span_(console, cache_console, console_y);
+    for (int console_x = span.begin; console_x < span.end; ++console_x) {
+      // Get the console index and tileset graphic.
+      int console_i = console_y * console->w + console_x;
+      const struct TCOD_ConsoleTile* tile = &console->tiles[console_i];
+      if (cache_console) {
+        struct TCOD_ConsoleTile* cache_tile = &cache_console->tiles[console_i];
+        if (tiles_equal(cache_tile, tile)) continue;
+        *cache_tile = *tile;
       }
+      TCOD_ColorRGBA* out = (TCOD_ColorRGBA*)(
+          (char*)band->out_rgba
+          + console_y * tileset->tile_height * band->stride
+          + console_x * tileset->tile_width * sizeof(*out)
+      );
+      render_tile(tileset, tile, out, band->stride);
     }
   }
 }
 #ifndef NO_SDL
+static int render_band_thread(void* band) {
+  render_band(band);
+  return 0;
+}
+#endif  // NO_SDL
+/**
+    The most bands a console will be split into.
+ */
+#define TCOD_RENDER_MAX_BANDS 16
+/**
+    Frames which redraw fewer pixels than this are rendered on the calling thread only.
+    Below this size the cost of starting threads outweighs the work.
+ */
+#define TCOD_RENDER_THREAD_MIN_PIXELS (1 << 20)
+#ifndef NO_SDL
+/**
+    Return the number of tiles which need to be redrawn, counting no further than `limit`.
+ */
+static int64_t count_redraw_tiles(const TCOD_Console* console, const TCOD_Console* cache, int64_t limit) {
+  int64_t count = 0;
+  for (int y = 0; y < console->h && count < limit; ++y) {
+    const TCOD_ConsoleDirtySpan span = TCOD_console_get_redraw_span_(console, cache, y);
+    if (!cache) {
+      count += MAX(span.end - span.begin, 0);
+      continue;
+    }
+    for (int i = y * console->w + span.begin; i < y * console->w + span.end; ++i) {
+      count += !tiles_equal(&console->tiles[i], &cache->tiles[i]);
+    }
+  }
+  return count;
+}
+#endif  // NO_SDL
+TCOD_Error TCOD_tileset_render_to_rgba(
+    const TCOD_Tileset* __restrict tileset,
+    const TCOD_Console* __restrict console,
+    TCOD_Console* __restrict* cache,
+    TCOD_ColorRGBA* __restrict out_rgba,
+    int stride) {
+  if (!tileset) {
+    TCOD_set_errorv("Tileset argument must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (!console) {
+    TCOD_set_errorv("Console argument must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (!out_rgba) {
+    TCOD_set_errorv("Output pixels must not be NULL.");
+    return TCOD_E_INVALID_ARGUMENT;
+  }
+  if (cache) {
+    if (*cache) {
+      if ((*cache)->w != console->w || (*cache)->h != console->h) {
+        TCOD_console_delete(*cache);
+        *cache = NULL;
+      }
+    }
+    if (!*cache) {
+      *cache = TCOD_console_new(console->w, console->h);
+      if (!*cache) return TCOD_E_OUT_OF_MEMORY;
+      for (int i = 0; i < (*cache)->elements; ++i) (*cache)->tiles[i].ch = -1;
+      (void)TCOD_console_set_write_tracking(*cache, true);  // Optional, allows skipping unchanged rows.
+    }
+  }
+  TCOD_Console* cache_console = cache ? *cache : NULL;
+  int n_bands = 1;
+#ifndef NO_SDL
+  // Only start threads when enough tiles changed, unchanged tiles cost a comparison and nothing else.
+  const int64_t min_tiles = TCOD_RENDER_THREAD_MIN_PIXELS / MAX(tileset->tile_length, 1);
+  if ((int64_t)console->elements >= min_tiles && count_redraw_tiles(console, cache_console, min_tiles) >= min_tiles) {
+    n_bands = MIN(MIN(SDL_GetCPUCount(), TCOD_RENDER_MAX_BANDS), console->h);
+    n_bands = MAX(n_bands, 1);
+  }
+#endif  // NO_SDL
+  struct RenderBand bands[TCOD_RENDER_MAX_BANDS];
+  for (int i = 0; i < n_bands; ++i) {
+    bands[i] = (struct RenderBand){
+        .tileset = tileset,
+        .console = console,
+        .cache = cache_console,
+        .out_rgba = out_rgba,
+        .stride = stride,
+        .y_begin = console->h * i / n_bands,
+        .y_end = console->h * (i + 1) / n_bands,
+    };
+  }
+#ifndef NO_SDL
+  SDL_Thread* threads[TCOD_RENDER_MAX_BANDS] = {NULL};
+  for (int i = 1; i < n_bands; ++i) threads[i] = SDL_CreateThread(render_band_thread, "libtcod render", &bands[i]);
+#endif  // NO_SDL
+  render_band(&bands[0]);
+#ifndef NO_SDL
+  for (int i = 1; i < n_bands; ++i) {
+    if (threads[i]) {
+      SDL_WaitThread(threads[i], NULL);
+    } else {
+      render_band(&bands[i]);  // The thread could not be started, render this band here instead.
+    }
+  }
+#endif  // NO_SDL
+  TCOD_console_end_redraw_(console, cache_console);
+  return TCOD_E_OK;
+}
+#ifndef NO_SDL
 TCOD_Error TCOD_tileset_render_to_surface(
     const TCOD_Tileset* __restrict tileset,
     const TCOD_Console* __restrict console,
@@ -93,39 +280,12 @@ TCOD_Error TCOD_tileset_render_to_surface(
   }
   if (!*surface_out) {
     *surface_out = SDL_CreateRGBSurfaceWithFormat(0, total_width, total_height, 32, SDL_PIXELFORMAT_RGBA32);
-  }
-  if (cache) {
-    if (*cache) {
-      if ((*cache)->w != console->w || (*cache)->h != console->h) {
-        TCOD_console_delete(*cache);
-        *cache = NULL;
-      }
-    }
-    if (!*cache) {
-      *cache = TCOD_console_new(console->w, console->h);
+    if (!*surface_out) return TCOD_set_errorvf("SDL error: %s", SDL_GetError());
+    if (cache && *cache) {
+      TCOD_console_delete(*cache);  // The new surface is blank, so the cache is no longer valid.
+      *cache = NULL;
     }
   }
-  for (int console_y = 0; console_y < console->h; ++console_y) {
-    for (int console_x = 0; console_x < console->w; ++console_x) {
-      // Get the console index and tileset graphic.
-      int console_i = console_y * console->w + console_x;
-      const struct TCOD_ConsoleTile* tile = &console->tiles[console_i];
-      if (cache && *cache) {
-        const struct TCOD_ConsoleTile* cache_tile = &(*cache)->tiles[console_i];
-        if (cache_tile->ch == tile->ch && cache_tile->fg.r == tile->fg.r && cache_tile->fg.g == tile->fg.g &&
-            cache_tile->fg.b == tile->fg.b && cache_tile->fg.a == tile->fg.a && cache_tile->bg.r == tile->bg.r &&
-            cache_tile->bg.g == tile->bg.g && cache_tile->bg.b == tile->bg.b && cache_tile->bg.a == tile->bg.a) {
-          continue;
-        }
-      }
-      TCOD_ColorRGBA* out = (TCOD_ColorRGBA*)(
-          (char*)(*surface_out)->pixels
-          + console_y * tileset->tile_height * (*surface_out)->pitch
-          + console_x * tileset->tile_width * sizeof(*out)
-      );
-      render_tile(tileset, tile, out, (*surface_out)->pitch);
-    }
-  }
-  return TCOD_E_OK;
+  return TCOD_tileset_render_to_rgba(tileset, console, cache, (*surface_out)->pixels, (*surface_out)->pitch);
 }
 #endif  // NO_SDL
@@ -39,6 +39,30 @@ struct SDL_Surface;
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
+/**
+    Render a console into a caller owned RGBA pixel buffer.
+
+    `tileset`, `console`, and `cache` work the same as in
+    `TCOD_tileset_render_to_surface`.  Only tiles which differ from `cache` are
+    written, so `out_rgba` must hold the previous output when a cache is given.
+
+    `out_rgba` must hold `console->h * tileset->tile_height` rows of `stride`
+    bytes, each row being at least `console->w * tileset->tile_width` pixels.
+
+    Lazily loaded tilesets must have their tiles loaded first with
+    `TCOD_tileset_request_console_tiles`.
+
+    Returns a negative value on error, see `TCOD_get_error`.
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCOD_PUBLIC TCOD_Error TCOD_tileset_render_to_rgba(
+    const TCOD_Tileset* __restrict tileset,
+    const TCOD_Console* __restrict console,
+    TCOD_Console* __restrict* cache,
+    TCOD_ColorRGBA* __restrict out_rgba,
+    int stride);
 #ifndef NO_SDL
 /**
     Render a console to a SDL_Surface with a software renderer.
@@ -122,35 +122,56 @@ void render_glyph(const struct FontLoader* __restrict loader, int glyph) {
     }
   }
 }
+/**
+ *  Setup `loader` for `font_info` and allocate its tileset and tile buffers.
+ *
+ *  Returns NULL on failure.
+ */
 TCOD_NODISCARD
-static struct TCOD_Tileset* tileset_from_ttf(const stbtt_fontinfo* font_info, int tile_width, int tile_height) {
-  struct FontLoader loader = {
+static struct TCOD_Tileset* init_font_loader(
+    struct FontLoader* __restrict loader, const stbtt_fontinfo* font_info, int tile_width, int tile_height) {
+  *loader = (struct FontLoader){
       .info = font_info,
       .scale = stbtt_ScaleForPixelHeight(font_info, (float)tile_height),
       .align_x = 0.5f,
       .align_y = 0.5f,
   };
   stbtt_GetFontBoundingBox(
-      font_info, &loader.font_bbox.xMin, &loader.font_bbox.yMin, &loader.font_bbox.xMax, &loader.font_bbox.yMax);
-  stbtt_GetFontVMetrics(font_info, &loader.ascent, &loader.descent, &loader.line_gap);
+      font_info, &loader->font_bbox.xMin, &loader->font_bbox.yMin, &loader->font_bbox.xMax, &loader->font_bbox.yMax);
+  stbtt_GetFontVMetrics(font_info, &loader->ascent, &loader->descent, &loader->line_gap);
   if (tile_width <= 0) {
-    tile_width = (int)((float)(bbox_width(&loader.font_bbox)) * loader.scale);
+    tile_width = (int)((float)(bbox_width(&loader->font_bbox)) * loader->scale);
   }
-  float font_width = bbox_width(&loader.font_bbox) * loader.scale;
+  float font_width = bbox_width(&loader->font_bbox) * loader->scale;
   if (font_width > tile_width) {
     // Shrink the font to fit its tile width.
-    loader.scale *= (float)tile_width / font_width;
-  }
-  loader.tileset = TCOD_tileset_new(tile_width, tile_height);
-  loader.tile = malloc(sizeof(*loader.tile) * loader.tileset->tile_length);
-  loader.tile_alpha = malloc(sizeof(*loader.tile_alpha) * loader.tileset->tile_length);
-  if (!loader.tileset || !loader.tile || !loader.tile_alpha) {
-    TCOD_tileset_delete(loader.tileset);
-    free(loader.tile);
-    free(loader.tile_alpha);
+    loader->scale *= (float)tile_width / font_width;
+  }
+  loader->tileset = TCOD_tileset_new(tile_width, tile_height);
+  loader->tile = loader->tileset ? malloc(sizeof(*loader->tile) * loader->tileset->tile_length) : NULL;
+  loader->tile_alpha = loader->tileset ? malloc(sizeof(*loader->tile_alpha) * loader->tileset->tile_length) : NULL;
+  if (!loader->tileset || !loader->tile || !loader->tile_alpha) {
+    TCOD_set_errorv("Out of memory while loading tileset.");
+    TCOD_tileset_delete(loader->tileset);
+    free(loader->tile);
+    free(loader->tile_alpha);
+    loader->tileset = NULL;
+    loader->tile = NULL;
+    loader->tile_alpha = NULL;
+  }
+  return loader->tileset;
+}
+/**
+ *  The highest codepoint checked for glyphs.
+ */
+#define TCOD_TRUETYPE_MAX_CODEPOINT 0x1ffff
+TCOD_NODISCARD
+static struct TCOD_Tileset* tileset_from_ttf(const stbtt_fontinfo* font_info, int tile_width, int tile_height) {
+  struct FontLoader loader;
+  if (!init_font_loader(&loader, font_info, tile_width, tile_height)) {
     return NULL;
   }
-  for (int codepoint = 1; codepoint <= 0x1ffff; ++codepoint) {
+  for (int codepoint = 1; codepoint <= TCOD_TRUETYPE_MAX_CODEPOINT; ++codepoint) {
     int glyph = stbtt_FindGlyphIndex(font_info, codepoint);
     if (!glyph) {
       continue;
@@ -167,6 +188,44 @@ static struct TCOD_Tileset* tileset_from_ttf(const stbtt_fontinfo* font_info, in
   free(loader.tile_alpha);
   return loader.tileset;
 }
+/**
+ *  A font which renders its glyphs on demand.  Owned by its tileset.
+ */
+struct LazyFont {
+  unsigned char* font_data;
+  stbtt_fontinfo font_info;
+  struct FontLoader loader;
+  /** A bit is set for each codepoint which has already been looked up. */
+  uint32_t checked[(TCOD_TRUETYPE_MAX_CODEPOINT + 1) / 32];
+};
+static void lazy_font_delete(void* userdata) {
+  struct LazyFont* lazy = userdata;
+  free(lazy->loader.tile);
+  free(lazy->loader.tile_alpha);
+  free(lazy->font_data);
+  free(lazy);
+}
+/**
+ *  Render and assign the tile for `codepoint`, only the first lookup for each codepoint does any work.
+ */
+static int lazy_font_load_tile(struct TCOD_Tileset* tileset, int codepoint) {
+  struct LazyFont* lazy = tileset->tile_loader;
+  if (codepoint <= 0 || codepoint > TCOD_TRUETYPE_MAX_CODEPOINT) {
+    return 0;
+  }
+  uint32_t* checked = &lazy->checked[codepoint / 32];
+  const uint32_t bit = UINT32_C(1) << (codepoint % 32);
+  if (*checked & bit) {
+    return 0;
+  }
+  *checked |= bit;
+  const int glyph = stbtt_FindGlyphIndex(&lazy->font_info, codepoint);
+  if (!glyph) {
+    return 0;
+  }
+  render_glyph(&lazy->loader, glyph);
+  return TCOD_tileset_set_tile_(tileset, codepoint, lazy->loader.tile);
+}
 
 TCOD_Tileset* TCOD_load_truetype_font_(const char* path, int tile_width, int tile_height) {
   unsigned char* font_data = TCOD_load_binary_file_(path, NULL);
@@ -183,6 +242,34 @@ TCOD_Tileset* TCOD_load_truetype_font_(const char* path, int tile_width, int til
   free(font_data);
   return tileset;
 }
+TCOD_Tileset* TCOD_load_truetype_font_lazy_(const char* path, int tile_width, int tile_height) {
+  struct LazyFont* lazy = calloc(1, sizeof(*lazy));
+  if (!lazy) {
+    TCOD_set_errorv("Out of memory while loading tileset.");
+    return NULL;
+  }
+  lazy->font_data = TCOD_load_binary_file_(path, NULL);
+  if (!lazy->font_data) {
+    free(lazy);
+    return NULL;
+  }
+  if (!stbtt_InitFont(&lazy->font_info, lazy->font_data, 0)) {
+    TCOD_set_errorvf("Failed to read font file:\n%s", path);
+    free(lazy->font_data);
+    free(lazy);
+    return NULL;
+  }
+  struct TCOD_Tileset* tileset = init_font_loader(&lazy->loader, &lazy->font_info, tile_width, tile_height);
+  if (!tileset) {
+    free(lazy->font_data);
+    free(lazy);
+    return NULL;
+  }
+  tileset->tile_loader = lazy;
+  tileset->on_tile_loader_delete = lazy_font_delete;
+  tileset->on_tile_missing = lazy_font_load_tile;
+  return tileset;
+}
 int TCOD_tileset_load_truetype_(const char* path, int tile_width, int tile_height) {
   TCOD_Tileset* tileset = TCOD_load_truetype_font_(path, tile_width, tile_height);
   if (!tileset) {
@@ -43,6 +43,21 @@ extern "C" {
     This function is provisional and may change in future releases.
  */
 TCODLIB_API TCOD_NODISCARD TCOD_Tileset* TCOD_load_truetype_font_(const char* path, int tile_width, int tile_height);
+/**
+    Return a tileset from a TrueType font file which renders each glyph the first time it is requested.
+
+    The font file is kept in memory until the tileset is deleted.
+    Renderers request the glyphs used by a console before drawing it, see `TCOD_tileset_request_console_tiles`.
+    Glyphs which have not been requested yet are missing from `TCOD_tileset_get_tile`.
+
+    This function is provisional and may change in future releases.
+
+    \rst
+    .. versionadded:: Unreleased
+    \endrst
+ */
+TCODLIB_API TCOD_NODISCARD TCOD_Tileset* TCOD_load_truetype_font_lazy_(
+    const char* path, int tile_width, int tile_height);
 /**
     Set the global tileset from a TrueType font file.
 
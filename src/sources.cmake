@@ -17,6 +17,8 @@ target_sources(${PROJECT_NAME} PRIVATE
     libtcod/console.h
     libtcod/console.hpp
     libtcod/console_.cpp
+    libtcod/console_compact.c
+    libtcod/console_compact.h
     libtcod/console_drawing.c
     libtcod/console_drawing.h
     libtcod/console_etc.c
@@ -30,11 +32,14 @@ target_sources(${PROJECT_NAME} PRIVATE
     libtcod/console_rexpaint.c
     libtcod/console_rexpaint.h
     libtcod/console_rexpaint.hpp
+    libtcod/console_stack.c
+    libtcod/console_stack.h
     libtcod/console_types.h
     libtcod/console_types.hpp
     libtcod/context.c
     libtcod/context.h
     libtcod/context.hpp
+    libtcod/context_async.c
     libtcod/context_init.c
     libtcod/context_init.h
     libtcod/context_viewport.c
@@ -111,6 +116,8 @@ target_sources(${PROJECT_NAME} PRIVATE
     libtcod/portability.h
     libtcod/random.c
     libtcod/random.h
+    libtcod/renderer_headless.c
+    libtcod/renderer_headless.h
     libtcod/renderer_sdl2.c
     libtcod/renderer_sdl2.h
     libtcod/renderer_xterm.c
@@ -128,6 +135,8 @@ target_sources(${PROJECT_NAME} PRIVATE
     libtcod/tileset_bdf.c
     libtcod/tileset_bdf.h
     libtcod/tileset_bdf.hpp
+    libtcod/tileset_cache.c
+    libtcod/tileset_cache.h
     libtcod/tileset_fallback.c
     libtcod/tileset_fallback.h
     libtcod/tileset_fallback.hpp
@@ -202,6 +211,7 @@ install(FILES
     libtcod/config.h
     libtcod/console.h
     libtcod/console.hpp
+    libtcod/console_compact.h
     libtcod/console_drawing.h
     libtcod/console_etc.h
     libtcod/console_init.h
@@ -209,6 +219,7 @@ install(FILES
     libtcod/console_printing.hpp
     libtcod/console_rexpaint.h
     libtcod/console_rexpaint.hpp
+    libtcod/console_stack.h
     libtcod/console_types.h
     libtcod/console_types.hpp
     libtcod/context.h
@@ -254,6 +265,7 @@ install(FILES
     libtcod/pathfinder_frontier.h
     libtcod/portability.h
     libtcod/random.h
+    libtcod/renderer_headless.h
     libtcod/renderer_sdl2.h
     libtcod/renderer_xterm.h
     libtcod/sys.h
@@ -262,6 +274,7 @@ install(FILES
     libtcod/tileset.hpp
     libtcod/tileset_bdf.h
     libtcod/tileset_bdf.hpp
+    libtcod/tileset_cache.h
     libtcod/tileset_fallback.h
     libtcod/tileset_fallback.hpp
     libtcod/tileset_render.h
@@ -323,6 +336,8 @@ source_group(libtcod FILES
     libtcod/console.h
     libtcod/console.hpp
     libtcod/console_.cpp
+    libtcod/console_compact.c
+    libtcod/console_compact.h
     libtcod/console_drawing.c
     libtcod/console_drawing.h
     libtcod/console_etc.c
@@ -336,11 +351,14 @@ source_group(libtcod FILES
     libtcod/console_rexpaint.c
     libtcod/console_rexpaint.h
     libtcod/console_rexpaint.hpp
+    libtcod/console_stack.c
+    libtcod/console_stack.h
     libtcod/console_types.h
     libtcod/console_types.hpp
     libtcod/context.c
     libtcod/context.h
     libtcod/context.hpp
+    libtcod/context_async.c
     libtcod/context_init.c
     libtcod/context_init.h
     libtcod/context_viewport.c
@@ -417,6 +435,8 @@ source_group(libtcod FILES
     libtcod/portability.h
     libtcod/random.c
     libtcod/random.h
+    libtcod/renderer_headless.c
+    libtcod/renderer_headless.h
     libtcod/renderer_sdl2.c
     libtcod/renderer_sdl2.h
     libtcod/renderer_xterm.c
@@ -434,6 +454,8 @@ source_group(libtcod FILES
     libtcod/tileset_bdf.c
     libtcod/tileset_bdf.h
     libtcod/tileset_bdf.hpp
+    libtcod/tileset_cache.c
+    libtcod/tileset_cache.h
     libtcod/tileset_fallback.c
     libtcod/tileset_fallback.h
     libtcod/tileset_fallback.hpp
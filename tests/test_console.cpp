@@ -1,7 +1,13 @@
 
+#include <algorithm>
+#include <array>
 #include <catch2/catch_all.hpp>
 #include <libtcod/console.hpp>
+#include <libtcod/console_compact.h>
 #include <libtcod/console_printing.hpp>
+#include <libtcod/console_stack.h>
+#include <memory>
+#include <vector>
 
 #include "common.hpp"
 
@@ -110,3 +116,358 @@ TEST_CASE("Console wchar SMP", "[!nonportable][!mayfail][.]") {
   CHECK(console.getChar(0, 0) == 0x1F30D);
   CHECK(console.getChar(1, 0) == 0x20);
 }
+
+/// Return the dirty spans of a tracked console, with empty spans normalized to {0, 0}.
+static std::vector<std::array<int, 2>> get_dirty_rows(const TCOD_Console& console) {
+  std::vector<std::array<int, 2>> rows;
+  for (int y = 0; y < console.h; ++y) {
+    const TCOD_ConsoleDirtySpan& span = console.dirty_rows[y];
+    rows.push_back(span.begin < span.end ? std::array<int, 2>{span.begin, span.end} : std::array<int, 2>{0, 0});
+  }
+  return rows;
+}
+/// Mark every row of a tracked console as clean, the same as after a render.
+static void clean_dirty_rows(TCOD_Console& console) {
+  for (int y = 0; y < console.h; ++y) console.dirty_rows[y] = {console.w, 0};
+}
+
+TEST_CASE("Console write tracking") {
+  using Rows = std::vector<std::array<int, 2>>;
+  auto console = tcod::Console{5, 3};
+  TCOD_Console& c_console = *console.get();
+  REQUIRE(c_console.dirty_rows == nullptr);
+  TCOD_console_put_rgb(console.get(), 1, 1, '@', nullptr, nullptr, TCOD_BKGND_SET);  // Untracked write is harmless.
+
+  REQUIRE(TCOD_console_set_write_tracking(console.get(), true) == TCOD_E_OK);
+  REQUIRE(c_console.dirty_rows != nullptr);
+  CHECK(get_dirty_rows(c_console) == Rows{{0, 5}, {0, 5}, {0, 5}});  // Starts fully dirty.
+  clean_dirty_rows(c_console);
+
+  const TCOD_ColorRGB red{255, 0, 0};
+  TCOD_console_put_rgb(console.get(), 3, 1, 0, &red, nullptr, TCOD_BKGND_SET);
+  TCOD_console_put_rgb(console.get(), 1, 1, 0, nullptr, &red, TCOD_BKGND_SET);
+  CHECK(get_dirty_rows(c_console) == Rows{{0, 0}, {1, 4}, {0, 0}});
+  clean_dirty_rows(c_console);
+
+  TCOD_console_set_char(console.get(), 4, 2, 'x');
+  TCOD_console_put_char(console.get(), 0, 0, 'y', TCOD_BKGND_SET);
+  TCOD_console_put_rgb(console.get(), 10, 10, 'z', nullptr, nullptr, TCOD_BKGND_SET);  // Out-of-bounds is ignored.
+  CHECK(get_dirty_rows(c_console) == Rows{{0, 1}, {0, 0}, {4, 5}});
+  clean_dirty_rows(c_console);
+
+  auto other = tcod::Console{2, 2};
+  TCOD_console_blit(other.get(), 0, 0, 0, 0, console.get(), 4, 1, 1.0f, 1.0f);  // Clipped by the destination.
+  CHECK(get_dirty_rows(c_console) == Rows{{0, 0}, {4, 5}, {4, 5}});
+  clean_dirty_rows(c_console);
+
+  TCOD_console_mark_dirty(console.get(), -2, -2, 4, 3);
+  CHECK(get_dirty_rows(c_console) == Rows{{0, 2}, {0, 0}, {0, 0}});
+  TCOD_console_mark_dirty(console.get(), 2, 0, 0, 3);  // Empty regions are ignored.
+  CHECK(get_dirty_rows(c_console) == Rows{{0, 2}, {0, 0}, {0, 0}});
+  clean_dirty_rows(c_console);
+
+#ifndef TCOD_NO_UNICODE
+  tcod::print(console, {1, 2}, "ab", std::nullopt, std::nullopt);
+  CHECK(get_dirty_rows(c_console) == Rows{{0, 0}, {0, 0}, {1, 3}});
+  clean_dirty_rows(c_console);
+#endif  // TCOD_NO_UNICODE
+
+  console.clear();
+  CHECK(get_dirty_rows(c_console) == Rows{{0, 5}, {0, 5}, {0, 5}});
+  clean_dirty_rows(c_console);
+  TCOD_console_clear(console.get());
+  CHECK(get_dirty_rows(c_console) == Rows{{0, 5}, {0, 5}, {0, 5}});
+  clean_dirty_rows(c_console);
+  const auto same_size = tcod::Console{5, 3};
+  console = same_size;  // Copy assignment of the same size reuses the tracked console.
+  REQUIRE(console.get() == &c_console);
+  CHECK(get_dirty_rows(c_console) == Rows{{0, 5}, {0, 5}, {0, 5}});
+
+  REQUIRE(TCOD_console_set_write_tracking(console.get(), false) == TCOD_E_OK);
+  CHECK(c_console.dirty_rows == nullptr);
+}
+
+TEST_CASE("Console blit") {
+  auto src = tcod::Console{4, 2};
+  for (int y = 0; y < src.get_height(); ++y) {
+    for (int x = 0; x < src.get_width(); ++x) {
+      src.at(x, y) = {'a' + x, {255, 255, 255, 255}, {static_cast<uint8_t>(x * 50), static_cast<uint8_t>(y), 0, 255}};
+    }
+  }
+  SECTION("Opaque blits copy tiles as is.") {
+    auto dst = tcod::Console{5, 3};
+    TCOD_console_blit(src.get(), 0, 0, 0, 0, dst.get(), 1, 1, 1.0f, 1.0f);  // Clipped by the destination.
+    for (int x = 0; x < 4; ++x) {
+      CHECK(dst.at(x + 1, 1) == src.at(x, 0));
+      CHECK(dst.at(x + 1, 2) == src.at(x, 1));
+    }
+    CHECK(dst.at(0, 0) == TCOD_ConsoleTile{' ', {255, 255, 255, 255}, {0, 0, 0, 255}});
+  }
+  SECTION("Translucent source tiles are blended during opaque blits.") {
+    auto dst = tcod::Console{4, 2};
+    src.at(2, 0).bg.a = 0;
+    TCOD_console_blit(src.get(), 0, 0, 0, 0, dst.get(), 0, 0, 1.0f, 1.0f);
+    CHECK(dst.at(1, 0) == src.at(1, 0));
+    CHECK(dst.at(2, 0).bg == TCOD_ColorRGBA{0, 0, 0, 255});
+    CHECK(dst.at(3, 0) == src.at(3, 0));
+  }
+  SECTION("Key color tiles are skipped.") {
+    auto dst = tcod::Console{4, 2};
+    const TCOD_ColorRGB key{50, 0, 0};
+    TCOD_console_blit_key_color(src.get(), 0, 0, 0, 0, dst.get(), 0, 0, 1.0f, 1.0f, &key);
+    CHECK(dst.at(0, 0) == src.at(0, 0));
+    CHECK(dst.at(1, 0) == TCOD_ConsoleTile{' ', {255, 255, 255, 255}, {0, 0, 0, 255}});
+    CHECK(dst.at(1, 1) == src.at(1, 1));
+    TCOD_console_blit_key_color(src.get(), 0, 0, 0, 0, dst.get(), 0, 0, 0.5f, 0.5f, &key);
+    CHECK(dst.at(1, 0) == TCOD_ConsoleTile{' ', {255, 255, 255, 255}, {0, 0, 0, 255}});
+  }
+  SECTION("Fractional alpha blends the background.") {
+    auto dst = tcod::Console{4, 2};
+    src.at(3, 0).bg = {255, 255, 255, 255};
+    TCOD_console_blit(src.get(), 0, 0, 0, 0, dst.get(), 0, 0, 0.5f, 0.5f);
+    const auto bg = dst.at(3, 0).bg;
+    CHECK(bg.r == Catch::Approx(127).margin(1));
+    CHECK(bg.g == Catch::Approx(127).margin(1));
+    CHECK(bg.a == 255);
+  }
+}
+
+TEST_CASE("Console blit benchmarks", "[.benchmark]") {
+  auto src = tcod::Console{200, 100};
+  auto dst = tcod::Console{200, 100};
+  BENCHMARK("Opaque") {
+    TCOD_console_blit(src.get(), 0, 0, 0, 0, dst.get(), 0, 0, 1.0f, 1.0f);
+    return dst.at(0, 0);
+  };
+  BENCHMARK("Fractional alpha") {
+    TCOD_console_blit(src.get(), 0, 0, 0, 0, dst.get(), 0, 0, 0.5f, 0.5f);
+    return dst.at(0, 0);
+  };
+  const TCOD_ColorRGB key{0, 0, 0};
+  BENCHMARK("Key color") {
+    TCOD_console_blit_key_color(src.get(), 0, 0, 0, 0, dst.get(), 0, 0, 1.0f, 1.0f, &key);
+    return dst.at(0, 0);
+  };
+}
+
+TEST_CASE("Console blend rect") {
+  const int width = 7;
+  const int height = 5;
+  std::vector<TCOD_ColorRGB> colors(width * height);
+  for (int i = 0; i < width * height; ++i) {
+    colors[i] = {static_cast<uint8_t>(i * 37), static_cast<uint8_t>(i * 11 + 100), static_cast<uint8_t>(255 - i * 5)};
+  }
+  auto start = tcod::Console{width, height};
+  for (int i = 0; i < width * height; ++i) {
+    start.get()->tiles[i].bg = {static_cast<uint8_t>(i * 7), static_cast<uint8_t>(255 - i * 3), 128, 255};
+  }
+  const TCOD_bkgnd_flag_t flags[] = {
+      TCOD_BKGND_NONE,
+      TCOD_BKGND_SET,
+      TCOD_BKGND_MULTIPLY,
+      TCOD_BKGND_LIGHTEN,
+      TCOD_BKGND_DARKEN,
+      TCOD_BKGND_SCREEN,
+      TCOD_BKGND_COLOR_DODGE,
+      TCOD_BKGND_COLOR_BURN,
+      TCOD_BKGND_ADD,
+      TCOD_BKGND_ADDALPHA(0.6f),
+      TCOD_BKGND_BURN,
+      TCOD_BKGND_OVERLAY,
+      TCOD_BKGND_ALPHA(0.3f),
+  };
+  for (const auto flag : flags) {
+    // Blend a clipped rectangle, compared against blending one tile at a time.
+    auto expected = tcod::Console{width, height};
+    auto uniform_expected = tcod::Console{width, height};
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        expected.at(x, y) = uniform_expected.at(x, y) = start.at(x, y);
+        if (x < 1 || y < 1) continue;
+        TCOD_console_set_char_background(expected.get(), x, y, colors[(y - 1) * width + (x - 1)], flag);
+        TCOD_console_set_char_background(uniform_expected.get(), x, y, colors[0], flag);
+      }
+    }
+    auto console = tcod::Console{width, height};
+    auto uniform = tcod::Console{width, height};
+    std::copy(start.begin(), start.end(), console.begin());
+    std::copy(start.begin(), start.end(), uniform.begin());
+    REQUIRE(TCOD_console_blend_rect(console.get(), 1, 1, width, height, colors.data(), width, flag) == TCOD_E_OK);
+    REQUIRE(TCOD_console_blend_rect(uniform.get(), 1, 1, width, height, colors.data(), 0, flag) == TCOD_E_OK);
+    CHECK(std::equal(console.begin(), console.end(), expected.begin()));
+    CHECK(std::equal(uniform.begin(), uniform.end(), uniform_expected.begin()));
+  }
+  auto console = tcod::Console{width, height};
+  CHECK(TCOD_console_blend_rect(console.get(), 0, 0, width, height, colors.data(), 1, TCOD_BKGND_SET) < 0);
+  CHECK(TCOD_console_blend_rect(console.get(), 0, 0, width, height, nullptr, 0, TCOD_BKGND_SET) < 0);
+}
+
+TEST_CASE("Console blend rect benchmarks", "[.benchmark]") {
+  auto console = tcod::Console{200, 100};
+  std::vector<TCOD_ColorRGB> colors(200 * 100, TCOD_ColorRGB{128, 64, 32});
+  BENCHMARK("Per tile multiply") {
+    for (int y = 0; y < 100; ++y) {
+      for (int x = 0; x < 200; ++x) {
+        TCOD_console_set_char_background(console.get(), x, y, colors[y * 200 + x], TCOD_BKGND_MULTIPLY);
+      }
+    }
+    return console.at(0, 0);
+  };
+  BENCHMARK("Rect multiply") {
+    return TCOD_console_blend_rect(console.get(), 0, 0, 200, 100, colors.data(), 200, TCOD_BKGND_MULTIPLY);
+  };
+  BENCHMARK("Rect uniform overlay") {
+    return TCOD_console_blend_rect(console.get(), 0, 0, 200, 100, colors.data(), 0, TCOD_BKGND_OVERLAY);
+  };
+}
+
+/// Composite a stack from scratch with plain blits.
+static tcod::Console composite_reference(TCOD_ConsoleStack* stack, const std::vector<std::array<int, 2>>& offsets) {
+  auto out = tcod::Console{10, 6};
+  for (int i = 0; i < TCOD_console_stack_get_layer_count(stack); ++i) {
+    if (i == 2) {
+      const TCOD_ColorRGB key{0, 0, 0};
+      TCOD_console_blit_key_color(
+          TCOD_console_stack_get_layer(stack, i),
+          0,
+          0,
+          0,
+          0,
+          out.get(),
+          offsets[i][0],
+          offsets[i][1],
+          1.0f,
+          0.5f,
+          &key);
+    } else {
+      TCOD_console_blit(
+          TCOD_console_stack_get_layer(stack, i), 0, 0, 0, 0, out.get(), offsets[i][0], offsets[i][1], 1.0f, 1.0f);
+    }
+  }
+  return out;
+}
+
+TEST_CASE("Console stack") {
+  using Rows = std::vector<std::array<int, 2>>;
+  auto stack = std::unique_ptr<TCOD_ConsoleStack, decltype(&TCOD_console_stack_delete)>{
+      TCOD_console_stack_new(10, 6), &TCOD_console_stack_delete};
+  REQUIRE(stack);
+  REQUIRE(TCOD_console_stack_add_layer(stack.get(), 10, 6) == 0);
+  REQUIRE(TCOD_console_stack_add_layer(stack.get(), 3, 2) == 1);
+  REQUIRE(TCOD_console_stack_add_layer(stack.get(), 4, 4) == 2);
+  CHECK(TCOD_console_stack_get_layer(stack.get(), 3) == nullptr);
+  std::vector<std::array<int, 2>> offsets{{0, 0}, {1, 1}, {5, 2}};
+  for (int i = 0; i < 3; ++i) {
+    TCOD_Console* layer = TCOD_console_stack_get_layer(stack.get(), i);
+    for (int y = 0; y < layer->h; ++y) {
+      for (int x = 0; x < layer->w; ++x) {
+        const auto value = static_cast<uint8_t>(i * 80 + x * 10 + y);
+        layer->tiles[y * layer->w + x] = {'a' + i, {value, 255, 0, 255}, {value, 0, 100, 255}};
+      }
+    }
+    REQUIRE(TCOD_console_stack_set_layer_offset(stack.get(), i, offsets[i][0], offsets[i][1]) == TCOD_E_OK);
+  }
+  const TCOD_ColorRGB key{0, 0, 0};
+  TCOD_console_put_rgb(TCOD_console_stack_get_layer(stack.get(), 2), 0, 0, 0, nullptr, &key, TCOD_BKGND_SET);
+  REQUIRE(TCOD_console_stack_set_layer_key_color(stack.get(), 2, &key) == TCOD_E_OK);
+  REQUIRE(TCOD_console_stack_set_layer_alpha(stack.get(), 2, 1.0f, 0.5f) == TCOD_E_OK);
+
+  auto out = tcod::Console{10, 6};
+  REQUIRE(TCOD_console_set_write_tracking(out.get(), true) == TCOD_E_OK);
+  REQUIRE(TCOD_console_stack_composite(stack.get(), out.get()) == TCOD_E_OK);
+  auto expected = composite_reference(stack.get(), offsets);
+  CHECK(std::equal(out.begin(), out.end(), expected.begin()));
+  clean_dirty_rows(*out.get());
+
+  SECTION("Nothing is redrawn when nothing changed.") {
+    REQUIRE(TCOD_console_stack_composite(stack.get(), out.get()) == TCOD_E_OK);
+    CHECK(get_dirty_rows(*out.get()) == Rows{{0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}});
+  }
+  SECTION("Only written regions are redrawn.") {
+    TCOD_console_set_char(TCOD_console_stack_get_layer(stack.get(), 1), 2, 1, 'z');
+    REQUIRE(TCOD_console_stack_composite(stack.get(), out.get()) == TCOD_E_OK);
+    CHECK(get_dirty_rows(*out.get()) == Rows{{0, 0}, {0, 0}, {3, 4}, {0, 0}, {0, 0}, {0, 0}});
+    expected = composite_reference(stack.get(), offsets);
+    CHECK(std::equal(out.begin(), out.end(), expected.begin()));
+  }
+  SECTION("Moving a layer redraws its old and new positions.") {
+    offsets[1] = {-1, 4};
+    REQUIRE(TCOD_console_stack_set_layer_offset(stack.get(), 1, -1, 4) == TCOD_E_OK);
+    REQUIRE(TCOD_console_stack_composite(stack.get(), out.get()) == TCOD_E_OK);
+    CHECK(get_dirty_rows(*out.get()) == Rows{{0, 0}, {1, 4}, {1, 4}, {0, 0}, {0, 2}, {0, 2}});
+    expected = composite_reference(stack.get(), offsets);
+    CHECK(std::equal(out.begin(), out.end(), expected.begin()));
+  }
+  SECTION("Hidden layers are not drawn.") {
+    REQUIRE(TCOD_console_stack_set_layer_visible(stack.get(), 0, false) == TCOD_E_OK);
+    REQUIRE(TCOD_console_stack_composite(stack.get(), out.get()) == TCOD_E_OK);
+    TCOD_console_set_char(TCOD_console_stack_get_layer(stack.get(), 0), 0, 0, 'z');  // Ignored while hidden.
+    REQUIRE(TCOD_console_stack_composite(stack.get(), out.get()) == TCOD_E_OK);
+    CHECK(out.at(0, 0) == TCOD_ConsoleTile{' ', {255, 255, 255, 255}, {0, 0, 0, 255}});
+    REQUIRE(TCOD_console_stack_set_layer_visible(stack.get(), 0, true) == TCOD_E_OK);
+    REQUIRE(TCOD_console_stack_composite(stack.get(), out.get()) == TCOD_E_OK);
+    expected = composite_reference(stack.get(), offsets);
+    CHECK(std::equal(out.begin(), out.end(), expected.begin()));
+  }
+  SECTION("Errors.") {
+    auto wrong_size = tcod::Console{3, 3};
+    CHECK(TCOD_console_stack_composite(stack.get(), wrong_size.get()) == TCOD_E_INVALID_ARGUMENT);
+    CHECK(TCOD_console_stack_set_layer_visible(stack.get(), -1, false) == TCOD_E_INVALID_ARGUMENT);
+  }
+}
+
+TEST_CASE("Compact console") {
+  auto console = tcod::Console{6, 4};
+  for (int y = 0; y < console.get_height(); ++y) {
+    for (int x = 0; x < console.get_width(); ++x) {
+      console.at(x, y) = {0x2500 + x, {static_cast<uint8_t>(x), 0, 0, 255}, {0, static_cast<uint8_t>(y), 0, 128}};
+    }
+  }
+  auto compact = std::unique_ptr<TCOD_CompactConsole, decltype(&TCOD_compact_console_delete)>{
+      TCOD_compact_console_new_from(console.get()), &TCOD_compact_console_delete};
+  REQUIRE(compact);
+  CHECK(TCOD_compact_console_get_width(compact.get()) == 6);
+  CHECK(TCOD_compact_console_get_height(compact.get()) == 4);
+  TCOD_ConsoleTile tile{};
+  REQUIRE(TCOD_compact_console_get(compact.get(), 5, 3, &tile) == TCOD_E_OK);
+  CHECK(tile == console.at(5, 3));
+  CHECK(TCOD_compact_console_get(compact.get(), 6, 0, &tile) == TCOD_E_INVALID_ARGUMENT);
+
+  const TCOD_ColorRGBA red{255, 0, 0, 255};
+  REQUIRE(TCOD_compact_console_put(compact.get(), 1, 1, '@', &red, nullptr) == TCOD_E_OK);
+  console.at(1, 1).ch = '@';
+  console.at(1, 1).fg = red;
+
+  auto out = tcod::Console{4, 4};
+  REQUIRE(TCOD_console_set_write_tracking(out.get(), true) == TCOD_E_OK);
+  clean_dirty_rows(*out.get());
+  REQUIRE(TCOD_compact_console_blit(compact.get(), 0, 0, 0, 0, out.get(), -1, 1) == TCOD_E_OK);  // Clipped.
+  CHECK(get_dirty_rows(*out.get()) == std::vector<std::array<int, 2>>{{0, 0}, {0, 4}, {0, 4}, {0, 4}});
+  for (int y = 1; y < 4; ++y) {
+    for (int x = 0; x < 4; ++x) CHECK(out.at(x, y) == console.at(x + 1, y - 1));
+  }
+  CHECK(out.at(0, 0) == TCOD_ConsoleTile{' ', {255, 255, 255, 255}, {0, 0, 0, 255}});
+
+  for (int i = 0; i < 1000; ++i) {  // Colors which are overwritten are reclaimed once the palette is full.
+    const TCOD_ColorRGBA color{static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8), 2, 3};
+    REQUIRE(TCOD_compact_console_put(compact.get(), 0, 0, 0, &color, &color) == TCOD_E_OK);
+  }
+  REQUIRE(TCOD_compact_console_get(compact.get(), 0, 0, &tile) == TCOD_E_OK);
+  CHECK(tile.fg == TCOD_ColorRGBA{231, 3, 2, 3});
+  REQUIRE(TCOD_compact_console_get(compact.get(), 5, 3, &tile) == TCOD_E_OK);
+  CHECK(tile == console.at(5, 3));  // Reclaiming colors does not change other tiles.
+  REQUIRE(TCOD_compact_console_get(compact.get(), 1, 1, &tile) == TCOD_E_OK);
+  CHECK(tile == console.at(1, 1));
+
+  auto full = std::unique_ptr<TCOD_CompactConsole, decltype(&TCOD_compact_console_delete)>{
+      TCOD_compact_console_new(16, 16), &TCOD_compact_console_delete};
+  REQUIRE(full);
+  int put_count = 0;
+  for (int i = 0; i < 256; ++i) {  // Every color stays in use.
+    const TCOD_ColorRGBA fg{static_cast<uint8_t>(i), 1, 2, 3};
+    const TCOD_ColorRGBA bg{static_cast<uint8_t>(i), 4, 5, 6};
+    if (TCOD_compact_console_put(full.get(), i % 16, i / 16, 0, &fg, &bg) != TCOD_E_OK) break;
+    ++put_count;
+  }
+  CHECK(put_count == 127);  // The palette is full with the 2 blank tile colors and 254 others.
+}
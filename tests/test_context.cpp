@@ -1,7 +1,11 @@
+#include <algorithm>
 #include <catch2/catch_all.hpp>
 #include <cstddef>
 #include <libtcod.hpp>
+#include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "common.hpp"
 
@@ -56,7 +60,167 @@ void test_renderer(TCOD_renderer_t renderer) {
 }
 
 TEST_CASE("SDL2 Renderer", "[!nonportable]") { test_renderer(TCOD_RENDERER_SDL2); }
+TEST_CASE("SDL2 Renderer pre-scaled tiles", "[!nonportable]") {
+  auto console = tcod::Console{16, 12};
+  TCOD_ContextParams params{};
+  params.tcod_version = TCOD_COMPILEDVERSION;
+  auto tileset = new_test_tileset(8, 8);
+  params.tileset = tileset.get();
+  params.renderer_type = TCOD_RENDERER_SDL2;
+  params.pixel_width = 16 * 8 * 2;
+  params.pixel_height = 12 * 8 * 2;
+  auto context = tcod::Context(params);
+  context.set_tile_scaling(TCOD_SCALE_FILTER_LINEAR);
+  TCOD_ViewportOptions viewport = TCOD_VIEWPORT_DEFAULT_;
+  viewport.integer_scaling = true;
+  context.present(console, viewport);
+  int width = 0;
+  int height = 0;
+  REQUIRE(TCOD_context_screen_capture(context.get_ptr().get(), nullptr, &width, &height) == TCOD_E_OK);
+  CHECK(width % (16 * 8) == 0);
+  CHECK(height % (12 * 8) == 0);
+  context.set_tile_scaling(TCOD_SCALE_FILTER_NONE);
+  context.present(console, viewport);
+  REQUIRE(TCOD_context_screen_capture(context.get_ptr().get(), nullptr, &width, &height) == TCOD_E_OK);
+  CHECK(width == 16 * 8);
+  CHECK(height == 12 * 8);
+}
 TEST_CASE("SDL Renderer", "[!nonportable]") { test_renderer(TCOD_RENDERER_SDL); }
 TEST_CASE("OPENGL Renderer", "[!nonportable]") { test_renderer(TCOD_RENDERER_OPENGL); }
 TEST_CASE("OPENGL2 Renderer", "[!nonportable]") { test_renderer(TCOD_RENDERER_OPENGL2); }
 #endif  // NO_SDL
+
+TEST_CASE("Headless renderer") {
+  auto tileset = tcod::TilesetPtr{TCOD_tileset_new(2, 3)};
+  const std::vector<TCOD_ColorRGBA> solid(2 * 3, TCOD_ColorRGBA{255, 255, 255, 255});
+  REQUIRE(TCOD_tileset_set_tile_(tileset.get(), '#', solid.data()) >= 0);
+  auto context = tcod::ContextPtr{TCOD_renderer_init_headless(64, 48, tileset.get())};
+  REQUIRE(context);
+  REQUIRE(TCOD_renderer_headless_get_pixels(context.get(), nullptr, nullptr) == nullptr);
+
+  auto console = tcod::Console{3, 2};
+  console.clear({' ', {255, 255, 255, 255}, {0, 0, 0, 255}});
+  console.at({1, 0}).bg = {255, 0, 0, 255};
+  console.at({2, 1}) = {'#', {0, 255, 0, 255}, {0, 0, 255, 255}};
+  REQUIRE(TCOD_context_present(context.get(), console.get(), nullptr) == TCOD_E_OK);
+
+  int width = 0;
+  int height = 0;
+  const TCOD_ColorRGBA* frame = TCOD_renderer_headless_get_pixels(context.get(), &width, &height);
+  REQUIRE(frame);
+  REQUIRE(width == 6);
+  REQUIRE(height == 6);
+  auto pixel_at = [&](int x, int y) { return frame[y * width + x]; };
+  CHECK(pixel_at(0, 0) == TCOD_ColorRGBA{0, 0, 0, 255});
+  CHECK(pixel_at(3, 2) == TCOD_ColorRGBA{255, 0, 0, 255});
+  CHECK(pixel_at(5, 5) == TCOD_ColorRGBA{0, 255, 0, 255});
+
+  // Changes after the first frame must be reflected even though unchanged tiles are skipped.
+  console.at({1, 0}).bg = {0, 0, 0, 255};
+  console.at({0, 1}).bg = {9, 9, 9, 255};
+  REQUIRE(TCOD_context_present(context.get(), console.get(), nullptr) == TCOD_E_OK);
+  frame = TCOD_renderer_headless_get_pixels(context.get(), &width, &height);
+  CHECK(pixel_at(3, 2) == TCOD_ColorRGBA{0, 0, 0, 255});
+  CHECK(pixel_at(1, 4) == TCOD_ColorRGBA{9, 9, 9, 255});
+  CHECK(pixel_at(5, 5) == TCOD_ColorRGBA{0, 255, 0, 255});
+
+  int capture_width = 0;
+  int capture_height = 0;
+  REQUIRE(TCOD_context_screen_capture(context.get(), nullptr, &capture_width, &capture_height) == TCOD_E_OK);
+  REQUIRE(capture_width == width);
+  REQUIRE(capture_height == height);
+  std::vector<TCOD_ColorRGBA> capture(capture_width * capture_height);
+  REQUIRE(TCOD_context_screen_capture(context.get(), capture.data(), &capture_width, &capture_height) == TCOD_E_OK);
+  CHECK(std::equal(capture.begin(), capture.end(), frame));
+
+  double tile_x = 5;
+  double tile_y = 4;
+  REQUIRE(TCOD_context_screen_pixel_to_tile_d(context.get(), &tile_x, &tile_y) == TCOD_E_OK);
+  CHECK(tile_x == Catch::Approx(2.5));
+  CHECK(tile_y == Catch::Approx(4.0 / 3.0));
+
+  int columns = 0;
+  int rows = 0;
+  REQUIRE(TCOD_context_recommended_console_size(context.get(), 1.0f, &columns, &rows) == TCOD_E_OK);
+  CHECK(columns == 32);
+  CHECK(rows == 16);
+}
+
+#ifndef TCOD_NO_THREADS
+TEST_CASE("Pipelined present") {
+  auto tileset = tcod::TilesetPtr{TCOD_tileset_new(2, 2)};
+  auto context = tcod::ContextPtr{TCOD_renderer_init_headless(0, 0, tileset.get())};
+  REQUIRE(context);
+  REQUIRE(TCOD_context_set_async_present(context.get(), true) == TCOD_E_OK);
+  REQUIRE(TCOD_context_set_async_present(context.get(), true) == TCOD_E_OK);  // Enabling twice is harmless.
+
+  auto console = tcod::Console{4, 3};
+  for (int frame = 0; frame < 50; ++frame) {
+    console.clear({' ', {255, 255, 255, 255}, {static_cast<uint8_t>(frame), 0, 0, 255}});
+    REQUIRE(TCOD_context_present(context.get(), console.get(), nullptr) == TCOD_E_OK);
+  }
+  console.clear({' ', {255, 255, 255, 255}, {0, 0, 0, 255}});  // Must not affect frames already presented.
+
+  double pixel_x = 5;
+  double pixel_y = 3;
+  REQUIRE(TCOD_context_screen_pixel_to_tile_d(context.get(), &pixel_x, &pixel_y) == TCOD_E_OK);
+  CHECK(pixel_x == 2.5);
+  CHECK(pixel_y == 1.5);
+
+  // Screen captures wait for the last presented frame.
+  int width = 0;
+  int height = 0;
+  std::vector<TCOD_ColorRGBA> capture(8 * 6);
+  REQUIRE(TCOD_context_screen_capture(context.get(), nullptr, &width, &height) == TCOD_E_OK);
+  REQUIRE(width == 8);
+  REQUIRE(height == 6);
+  REQUIRE(TCOD_context_screen_capture(context.get(), capture.data(), &width, &height) == TCOD_E_OK);
+  CHECK(capture.at(0) == TCOD_ColorRGBA{49, 0, 0, 255});
+  CHECK(capture.at(8 * 6 - 1) == TCOD_ColorRGBA{49, 0, 0, 255});
+
+  console.at({3, 2}).bg = {1, 2, 3, 255};
+  REQUIRE(TCOD_context_present(context.get(), console.get(), nullptr) == TCOD_E_OK);
+  REQUIRE(TCOD_context_set_async_present(context.get(), false) == TCOD_E_OK);  // Finishes the pending frame.
+  const TCOD_ColorRGBA* frame = TCOD_renderer_headless_get_pixels(context.get(), nullptr, nullptr);
+  REQUIRE(frame);
+  CHECK(frame[0] == TCOD_ColorRGBA{0, 0, 0, 255});
+  CHECK(frame[8 * 6 - 1] == TCOD_ColorRGBA{1, 2, 3, 255});
+
+  REQUIRE(TCOD_context_set_async_present(context.get(), true) == TCOD_E_OK);
+  REQUIRE(TCOD_context_present(context.get(), console.get(), nullptr) == TCOD_E_OK);
+  context.reset();  // Deleting the context must stop the render thread.
+}
+TEST_CASE("Pipelined present loads tiles on the presenting thread") {
+  static std::vector<std::thread::id> loader_threads;
+  loader_threads.clear();
+  auto tileset = tcod::TilesetPtr{TCOD_tileset_new(2, 2)};
+  tileset->on_tile_missing = [](TCOD_Tileset* self, int codepoint) -> int {
+    loader_threads.push_back(std::this_thread::get_id());
+    const std::vector<TCOD_ColorRGBA> pixels(4, TCOD_ColorRGBA{255, 255, 255, 255});
+    return TCOD_tileset_set_tile_(self, codepoint, pixels.data());
+  };
+  auto context = tcod::ContextPtr{TCOD_renderer_init_headless(0, 0, tileset.get())};
+  REQUIRE(context);
+  REQUIRE(TCOD_context_set_async_present(context.get(), true) == TCOD_E_OK);
+  auto console = tcod::Console{4, 3};
+  for (int frame = 0; frame < 10; ++frame) {
+    console.at({frame % 4, 0}).ch = 'a' + frame;
+    REQUIRE(TCOD_context_present(context.get(), console.get(), nullptr) == TCOD_E_OK);
+  }
+  REQUIRE(TCOD_context_set_async_present(context.get(), false) == TCOD_E_OK);
+  CHECK(loader_threads.size() == 11);  // The space of the blank console and each new letter.
+  for (const auto& id : loader_threads) CHECK(id == std::this_thread::get_id());
+}
+TEST_CASE("Error messages are per thread") {
+  // The render thread of a pipelined context must not overwrite errors seen by the main thread.
+  TCOD_set_error("main thread");
+  std::string other_error;
+  std::thread{[&]() {
+    other_error = TCOD_get_error();
+    TCOD_set_error("other thread");
+  }}.join();
+  CHECK(other_error.empty());
+  CHECK(std::string{TCOD_get_error()} == "main thread");
+  TCOD_clear_error();
+}
+#endif  // TCOD_NO_THREADS
@@ -0,0 +1,266 @@
+
+#include <libtcod/fov.h>
+
+#include <algorithm>
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/// Every field-of-view algorithm paired with its name.
+static const std::array<std::tuple<TCOD_fov_algorithm_t, const char*>, NB_FOV_ALGORITHMS> FOV_ALGORITHMS{{
+    {FOV_BASIC, "FOV_BASIC"},
+    {FOV_DIAMOND, "FOV_DIAMOND"},
+    {FOV_SHADOW, "FOV_SHADOW"},
+    {FOV_PERMISSIVE_0, "FOV_PERMISSIVE_0"},
+    {FOV_PERMISSIVE_1, "FOV_PERMISSIVE_1"},
+    {FOV_PERMISSIVE_2, "FOV_PERMISSIVE_2"},
+    {FOV_PERMISSIVE_3, "FOV_PERMISSIVE_3"},
+    {FOV_PERMISSIVE_4, "FOV_PERMISSIVE_4"},
+    {FOV_PERMISSIVE_5, "FOV_PERMISSIVE_5"},
+    {FOV_PERMISSIVE_6, "FOV_PERMISSIVE_6"},
+    {FOV_PERMISSIVE_7, "FOV_PERMISSIVE_7"},
+    {FOV_PERMISSIVE_8, "FOV_PERMISSIVE_8"},
+    {FOV_RESTRICTIVE, "FOV_RESTRICTIVE"},
+    {FOV_SYMMETRIC_SHADOWCAST, "FOV_SYMMETRIC_SHADOWCAST"},
+}};
+
+static tcod::MapPtr_ new_map_with_radius(int radius, bool start_transparent) {
+  int size = radius * 2 + 1;
+  tcod::MapPtr_ map{TCOD_map_new(size, size)};
+  TCOD_map_clear(map.get(), start_transparent, 0);
+  return map;
+}
+static tcod::MapPtr_ new_empty_map(int radius) { return new_map_with_radius(radius, true); }
+static tcod::MapPtr_ new_opaque_map(int radius) { return new_map_with_radius(radius, false); }
+static tcod::MapPtr_ new_corridor_map(int radius) {
+  tcod::MapPtr_ map{new_map_with_radius(radius, false)};
+  for (int i = 0; i < radius * 2 + 1; ++i) {
+    TCOD_map_set_properties(map.get(), radius, i, true, true);
+    TCOD_map_set_properties(map.get(), i, radius, true, true);
+  }
+  return map;
+}
+static tcod::MapPtr_ new_forest_map(int radius) {
+  // Forest map with 1 in 4 chance of a blocking tile.
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int> chance(0, 3);
+  tcod::MapPtr_ map{new_map_with_radius(radius, true)};
+  for (int i = 0; i < map->nbcells; ++i) {
+    if (chance(rng) == 0) {
+      map->cells[i].transparent = false;
+    }
+  }
+  map->cells[radius + radius * map->width].transparent = true;
+  return map;
+}
+static tcod::MapPtr_ new_rooms_map(int radius) {
+  // 8x8 rooms with a doorway in the middle of each wall.
+  tcod::MapPtr_ map{new_map_with_radius(radius, true)};
+  for (int y = 0; y < map->height; ++y) {
+    for (int x = 0; x < map->width; ++x) {
+      if ((x % 8 == 0 && y % 8 != 4) || (y % 8 == 0 && x % 8 != 4)) {
+        map->cells[x + y * map->width].transparent = false;
+      }
+    }
+  }
+  map->cells[radius + radius * map->width].transparent = true;
+  return map;
+}
+
+/// The generated map corpus, all maps are centered on their point-of-view.
+static const std::array<std::tuple<const char*, std::function<tcod::MapPtr_(int)>>, 5> FOV_MAP_KINDS{{
+    {"empty", new_empty_map},
+    {"opaque", new_opaque_map},
+    {"corridor", new_corridor_map},
+    {"forest", new_forest_map},
+    {"rooms", new_rooms_map},
+}};
+
+/// Return a copy of the field-of-view flags of `map`.
+static std::vector<bool> get_fov(const TCOD_Map& map) {
+  std::vector<bool> fov(map.nbcells);
+  for (int i = 0; i < map.nbcells; ++i) fov[i] = map.cells[i].fov;
+  return fov;
+}
+/**
+    Return the number of transparent cell pairs (A, B) where B can be seen from A but A can not be seen from B.
+ */
+static int count_asymmetric_pairs(TCOD_Map& map, TCOD_fov_algorithm_t algorithm) {
+  std::vector<std::vector<bool>> fov_from(map.nbcells);
+  for (int i = 0; i < map.nbcells; ++i) {
+    if (!map.cells[i].transparent) continue;
+    (void)!TCOD_map_compute_fov(&map, i % map.width, i / map.width, 0, true, algorithm);
+    fov_from[i] = get_fov(map);
+  }
+  int asymmetric = 0;
+  for (int a = 0; a < map.nbcells; ++a) {
+    if (fov_from[a].empty()) continue;
+    for (int b = 0; b < map.nbcells; ++b) {
+      if (fov_from[b].empty()) continue;
+      if (fov_from[a][b] && !fov_from[b][a]) ++asymmetric;
+    }
+  }
+  return asymmetric;
+}
+
+TEST_CASE("FOV conformance", "[fov]") {
+  const auto& map_kind = GENERATE(from_range(FOV_MAP_KINDS));
+  const int radius = GENERATE(4, 10, 50, 100);
+  const tcod::MapPtr_ map = std::get<1>(map_kind)(radius);
+  const int size = map->width;
+  for (const auto& [algorithm, name] : FOV_ALGORITHMS) {
+    INFO(name << " " << std::get<0>(map_kind) << "_r" << radius);
+    REQUIRE(TCOD_map_compute_fov(map.get(), radius, radius, radius, true, algorithm) == TCOD_E_OK);
+    const std::vector<bool> fov = get_fov(*map);
+    CHECK(TCOD_map_is_in_fov(map.get(), radius, radius));
+    // Square bounds are used here since some algorithms have a square radius.
+    REQUIRE(TCOD_map_compute_fov(map.get(), radius, radius, radius - 1, true, algorithm) == TCOD_E_OK);
+    for (int i = 0; i < map->nbcells; ++i) {
+      const bool on_edge = i % size == 0 || i % size == size - 1 || i / size == 0 || i / size == size - 1;
+      if (on_edge) CHECK(!map->cells[i].fov);
+    }
+    if (std::string(std::get<0>(map_kind)) == "empty") {
+      // With nothing blocking the view, every cell inside of the radius must be seen.
+      for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+          if ((x - radius) * (x - radius) + (y - radius) * (y - radius) >= radius * radius) continue;
+          CHECK(fov.at(x + y * size));
+        }
+      }
+    }
+    // Results must not depend on the previous state of the map.
+    REQUIRE(TCOD_map_compute_fov(map.get(), 0, 0, 0, true, algorithm) == TCOD_E_OK);
+    REQUIRE(TCOD_map_compute_fov(map.get(), radius, radius, radius, true, algorithm) == TCOD_E_OK);
+    CHECK(get_fov(*map) == fov);
+    // Walls are left unlit when light_walls is false, otherwise the results must match.
+    // Algorithms disagree on lighting an opaque point-of-view, so it is skipped.
+    REQUIRE(TCOD_map_compute_fov(map.get(), radius, radius, radius, false, algorithm) == TCOD_E_OK);
+    for (int i = 0; i < map->nbcells; ++i) {
+      if (i == radius + radius * size) continue;
+      if (map->cells[i].transparent) {
+        CHECK(map->cells[i].fov == fov.at(i));
+      } else {
+        CHECK(!map->cells[i].fov);
+      }
+    }
+  }
+}
+
+TEST_CASE("FOV determinism", "[fov]") {
+  const tcod::MapPtr_ map = new_forest_map(32);
+  const tcod::MapPtr_ map_copy = new_forest_map(32);
+  for (const auto& [algorithm, name] : FOV_ALGORITHMS) {
+    INFO(name);
+    REQUIRE(TCOD_map_compute_fov(map.get(), 32, 32, 24, true, algorithm) == TCOD_E_OK);
+    REQUIRE(TCOD_map_compute_fov(map_copy.get(), 32, 32, 24, true, algorithm) == TCOD_E_OK);
+    CHECK(get_fov(*map) == get_fov(*map_copy));
+  }
+}
+
+TEST_CASE("FOV_SYMMETRIC_SHADOWCAST symmetry", "[fov]") {
+  REQUIRE(count_asymmetric_pairs(*new_forest_map(12), FOV_SYMMETRIC_SHADOWCAST) == 0);
+  REQUIRE(count_asymmetric_pairs(*new_rooms_map(12), FOV_SYMMETRIC_SHADOWCAST) == 0);
+}
+
+TEST_CASE("FOV Benchmarks", "[.benchmark]") {
+  for (const auto& [map_name, new_map] : FOV_MAP_KINDS) {
+    for (const int radius : {4, 10, 50, 100}) {
+      const tcod::MapPtr_ map_ptr = new_map(radius);
+      TCOD_Map* map = map_ptr.get();
+      for (const auto& [algorithm_, algorithm_name] : FOV_ALGORITHMS) {
+        const TCOD_fov_algorithm_t algorithm = algorithm_;  // Structured bindings can not be captured.
+        BENCHMARK(std::string(map_name) + "_r" + std::to_string(radius) + " " + algorithm_name) {
+          (void)!TCOD_map_compute_fov(map, radius, radius, 0, true, algorithm);
+        };
+      }
+    }
+  }
+  for (const int radius : {10, 50}) {
+    std::vector<tcod::MapPtr_> levels;
+    std::vector<TCOD_Map*> levels_ptr;
+    for (int z = 0; z < 5; ++z) {
+      levels.emplace_back(new_forest_map(radius));
+      levels_ptr.emplace_back(levels.back().get());
+    }
+    BENCHMARK("forest_r" + std::to_string(radius) + " x5 levels TCOD_map_compute_fov_3d") {
+      (void)!TCOD_map_compute_fov_3d(levels_ptr.data(), 5, radius, radius, 2, 0, true);
+    };
+  }
+}
+
+TEST_CASE("FOV cost per visible cell", "[.benchmark]") {
+  // Reports the time spent per lit cell and the asymmetric pairs of each algorithm on each map.
+  using Clock = std::chrono::steady_clock;
+  for (const auto& [map_name, new_map] : FOV_MAP_KINDS) {
+    const tcod::MapPtr_ small_map = new_map(12);
+    for (const auto& [algorithm, algorithm_name] : FOV_ALGORITHMS) {
+      const int asymmetric = count_asymmetric_pairs(*small_map, algorithm);
+      for (const int radius : {4, 10, 50, 100}) {
+        const tcod::MapPtr_ map = new_map(radius);
+        constexpr int REPEATS = 16;
+        const auto start = Clock::now();
+        for (int i = 0; i < REPEATS; ++i) {
+          (void)!TCOD_map_compute_fov(map.get(), radius, radius, 0, true, algorithm);
+        }
+        const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / REPEATS;
+        int visible = 0;
+        for (int i = 0; i < map->nbcells; ++i) visible += map->cells[i].fov;
+        WARN(
+            map_name << "_r" << radius << " " << algorithm_name << ": " << visible << " visible, "
+                     << elapsed / std::max(visible, 1) << " ns/cell, " << asymmetric << " asymmetric pairs");
+      }
+    }
+  }
+}
+
+TEST_CASE("TCOD_map_compute_fov_3d", "[fov]") {
+  SECTION("A single level matches FOV_SYMMETRIC_SHADOWCAST.") {
+    for (const auto& map_ptr : {new_forest_map(20), new_rooms_map(20), new_corridor_map(20)}) {
+      const tcod::MapPtr_ expected = new_empty_map(20);
+      REQUIRE(TCOD_map_copy(map_ptr.get(), expected.get()) == TCOD_E_OK);
+      for (const int radius : {0, 10}) {
+        REQUIRE(TCOD_map_compute_fov(expected.get(), 20, 20, radius, true, FOV_SYMMETRIC_SHADOWCAST) == TCOD_E_OK);
+        TCOD_Map* levels[] = {map_ptr.get()};
+        REQUIRE(TCOD_map_compute_fov_3d(levels, 1, 20, 20, 0, radius, true) == TCOD_E_OK);
+        CHECK(get_fov(*map_ptr) == get_fov(*expected));
+      }
+    }
+  }
+  SECTION("Levels are seen through open pits.") {
+    // A basement, then solid ground with a single pit in the middle, then open air.
+    const tcod::MapPtr_ basement = new_empty_map(5);
+    const tcod::MapPtr_ ground = new_opaque_map(5);
+    const tcod::MapPtr_ air = new_empty_map(5);
+    TCOD_map_set_properties(ground.get(), 5, 5, true, true);
+    TCOD_Map* levels[] = {basement.get(), ground.get(), air.get()};
+    REQUIRE(TCOD_map_compute_fov_3d(levels, 3, 5, 5, 2, 0, true) == TCOD_E_OK);
+    CHECK(TCOD_map_is_in_fov(air.get(), 0, 0));
+    CHECK(TCOD_map_is_in_fov(ground.get(), 5, 5));
+    CHECK(TCOD_map_is_in_fov(ground.get(), 0, 0));  // The ground is lit as a wall from above.
+    CHECK(TCOD_map_is_in_fov(basement.get(), 5, 5));
+    CHECK(!TCOD_map_is_in_fov(basement.get(), 0, 0));
+    // Looking across the level above the pit.
+    REQUIRE(TCOD_map_compute_fov_3d(levels, 3, 0, 0, 2, 0, true) == TCOD_E_OK);
+    CHECK(TCOD_map_is_in_fov(air.get(), 10, 10));
+    CHECK(!TCOD_map_is_in_fov(basement.get(), 5, 5));
+    // Looking up out of the basement.
+    REQUIRE(TCOD_map_compute_fov_3d(levels, 3, 5, 5, 0, 0, false) == TCOD_E_OK);
+    CHECK(TCOD_map_is_in_fov(basement.get(), 0, 0));
+    CHECK(!TCOD_map_is_in_fov(ground.get(), 4, 5));
+    CHECK(TCOD_map_is_in_fov(air.get(), 5, 5));
+    CHECK(!TCOD_map_is_in_fov(air.get(), 0, 0));
+  }
+  SECTION("Levels must have the same shape.") {
+    const tcod::MapPtr_ small = new_empty_map(2);
+    const tcod::MapPtr_ large = new_empty_map(3);
+    TCOD_Map* levels[] = {small.get(), large.get()};
+    CHECK(TCOD_map_compute_fov_3d(levels, 2, 0, 0, 0, 0, true) == TCOD_E_INVALID_ARGUMENT);
+    CHECK(TCOD_map_compute_fov_3d(levels, 1, 0, 0, 1, 0, true) == TCOD_E_INVALID_ARGUMENT);
+  }
+}
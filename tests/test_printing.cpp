@@ -1,6 +1,10 @@
 #ifndef TCOD_NO_UNICODE
+#include <algorithm>
 #include <catch2/catch_all.hpp>
 #include <libtcod/console_printing.hpp>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "common.hpp"
 
@@ -20,6 +24,22 @@ TEST_CASE("tcod::print") {
 }
 
 TEST_CASE("String from printf.") { CHECK(tcod::stringf("%s%s%s", "1", "2", "3") == "123"); }
+TEST_CASE("Long formatted strings.") {
+  const std::string long_string(1000, 'x');
+  CHECK(tcod::stringf("%s%s", long_string.c_str(), "!") == long_string + "!");
+  auto console = tcod::Console{1100, 1};
+  for (int i = 0; i < 3; ++i) {  // Overflows the stack buffer and then reuses the scratch buffer.
+    const std::string text = std::string(600 + i * 200, 'a' + i) + "!";
+    REQUIRE(TCOD_console_printf(console.get(), 0, 0, "%s", text.c_str()) == TCOD_E_OK);
+    CHECK(to_string(console).substr(0, text.size()) == text);
+  }
+  auto wide_console = tcod::Console{5000, 1};
+  const std::string huge_text = std::string(4500, 'z') + "!";  // Too long for the scratch buffer.
+  REQUIRE(TCOD_console_printf(wide_console.get(), 0, 0, "%s", huge_text.c_str()) == TCOD_E_OK);
+  CHECK(to_string(wide_console).substr(0, huge_text.size()) == huge_text);
+  REQUIRE(  // The frame title is formatted by a separate caller.
+      TCOD_console_printf_frame(wide_console.get(), 0, 0, 5000, 1, 0, TCOD_BKGND_SET, "%s", huge_text.c_str()) >= 0);
+}
 
 void test_alignment(TCOD_alignment_t alignment) {
   // Compare alignment between the new and old functions.
@@ -105,4 +125,73 @@ TEST_CASE("Print params RGB") {
   TCOD_printf_rgb(console.get(), params, "%s", "B");
   REQUIRE(to_string(console) == " AB ");
 }
+TEST_CASE("Text layout") {
+  const std::string text =
+      "The quick brown fox jumps over the lazy dog.\n"
+      "\x06\x01\x02\x03" "Colored\x08 text - with dashes\u2029and paragraphs.";
+  const auto alignment = GENERATE(TCOD_LEFT, TCOD_CENTER, TCOD_RIGHT);
+  const int width = GENERATE(1, 7, 12, 40);
+  const int height = GENERATE(0, 3);
+  INFO("alignment=" << alignment << ", width=" << width << ", height=" << height);
+  static constexpr auto FG = TCOD_ColorRGB{1, 2, 3};
+  auto layout = std::unique_ptr<TCOD_TextLayout, decltype(&TCOD_text_layout_delete)>{
+      TCOD_text_layout_new(width, text.size(), text.data(), &FG, nullptr, alignment), &TCOD_text_layout_delete};
+  REQUIRE(layout);
+  CHECK(TCOD_text_layout_get_height(layout.get()) == TCOD_console_get_height_rect_wn(width, text.size(), text.data()));
+
+  auto expected = tcod::Console{44, 30};
+  auto console = tcod::Console{44, 30};
+  TCOD_console_printn_rect(
+      expected.get(), 2, 1, width, height, text.size(), text.data(), &FG, nullptr, TCOD_BKGND_SET, alignment);
+  REQUIRE(TCOD_text_layout_draw(layout.get(), console.get(), 2, 1, height, TCOD_BKGND_SET) == TCOD_E_OK);
+  CHECK(to_string(console) == to_string(expected));
+  CHECK(std::equal(console.begin(), console.end(), expected.begin()));
+}
+TEST_CASE("ASCII print fast path") {
+  // Printable ASCII runs are written directly, compare them to the per-glyph path used by text layouts.
+  const std::string text =
+      "A long line of plain ASCII text, which is printed 16 characters at a time! \x01with\x08 codes";
+  const int x = GENERATE(-5, 0, 3);
+  const auto flag = GENERATE(TCOD_BKGND_SET, TCOD_BKGND_MULTIPLY, TCOD_BKGND_ALPHA(0.5f));
+  INFO("x=" << x << ", flag=" << flag);
+  static constexpr auto FG = TCOD_ColorRGB{1, 2, 3};
+  static constexpr auto BG = TCOD_ColorRGB{100, 150, 200};
+  auto layout = std::unique_ptr<TCOD_TextLayout, decltype(&TCOD_text_layout_delete)>{
+      TCOD_text_layout_new(30, text.size(), text.data(), &FG, &BG, TCOD_LEFT), &TCOD_text_layout_delete};
+  REQUIRE(layout);
+  auto expected = tcod::Console{32, 5};
+  auto console = tcod::Console{32, 5};
+  for (auto& tile : expected) tile.bg = {50, 60, 70, 255};
+  std::copy(expected.begin(), expected.end(), console.begin());
+  TCOD_console_printn_rect(console.get(), x, 1, 30, 0, text.size(), text.data(), &FG, &BG, flag, TCOD_LEFT);
+  REQUIRE(TCOD_text_layout_draw(layout.get(), expected.get(), x, 1, 0, flag) == TCOD_E_OK);
+  CHECK(to_string(console) == to_string(expected));
+  CHECK(std::equal(console.begin(), console.end(), expected.begin()));
+}
+TEST_CASE("Print truncated color code") {
+  // Not null terminated, the color code is cut off by the end of the string.
+  const std::vector<char> text{'a', '\x06'};
+  auto console = tcod::Console{4, 1};
+  CHECK(
+      TCOD_console_printn(
+          console.get(), 0, 0, text.size(), text.data(), nullptr, nullptr, TCOD_BKGND_SET, TCOD_LEFT) >= 0);
+  CHECK(console.at({0, 0}).ch == 'a');
+  CHECK(console.at({1, 0}).ch == ' ');
+}
+TEST_CASE("Print benchmarks", "[.benchmark]") {
+  auto console = tcod::Console{80, 50};
+  const std::string ascii =
+      "The quick brown fox jumps over the lazy dog. Pack my box with five dozen liquor jugs. "
+      "How vexingly quick daft zebras jump! Sphinx of black quartz, judge my vow.";
+  const std::string unicode = "\u00C0 \u00E9l\u00E8ve \u2014 \u041F\u0440\u0438\u0432\u0435\u0442 \u043C\u0438\u0440 "
+                              "\u00C0 \u00E9l\u00E8ve \u2014 \u041F\u0440\u0438\u0432\u0435\u0442 \u043C\u0438\u0440";
+  BENCHMARK("ASCII print_rect") {
+    return TCOD_console_printn_rect(
+        console.get(), 0, 0, 40, 0, ascii.size(), ascii.data(), nullptr, nullptr, TCOD_BKGND_SET, TCOD_LEFT);
+  };
+  BENCHMARK("Unicode print_rect") {
+    return TCOD_console_printn_rect(
+        console.get(), 0, 0, 40, 0, unicode.size(), unicode.data(), nullptr, nullptr, TCOD_BKGND_SET, TCOD_LEFT);
+  };
+}
 #endif  // TCOD_NO_UNICODE
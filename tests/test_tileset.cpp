@@ -1,6 +1,14 @@
+#include <algorithm>
 #include <catch2/catch_all.hpp>
+#include <filesystem>
+#include <libtcod/console_types.hpp>
 #include <libtcod/tileset.hpp>
 #include <libtcod/tileset_bdf.hpp>
+#include <libtcod/tileset_cache.h>
+#include <libtcod/tileset_render.h>
+#include <set>
+#include <string>
+#include <vector>
 
 #include "common.hpp"
 
@@ -23,3 +31,234 @@ TEST_CASE("Load BDF.") {
   tileset = tcod::load_bdf(get_file("fonts/Tamzen5x9r.bdf"));
   REQUIRE(tileset);
 }
+
+TEST_CASE("Load BDF subset.") {
+  const auto path = get_file("fonts/ucs-fonts/4x6.bdf");
+  const auto full = tcod::load_bdf(path);
+  const auto subset = tcod::load_bdf(path, {'A', 'z', 0x2588, 0x10FFFF});
+  REQUIRE(subset);
+  CHECK(subset->tiles_count == 4);  // The blank tile and 3 glyphs, U+10FFFF is not in this font.
+  for (const int codepoint : {int{'A'}, int{'z'}, 0x2588}) {
+    REQUIRE(TCOD_tileset_get_tile_id_(subset.get(), codepoint) > 0);
+    CHECK(std::equal(
+        TCOD_tileset_get_tile(full.get(), codepoint),
+        TCOD_tileset_get_tile(full.get(), codepoint) + full->tile_length,
+        TCOD_tileset_get_tile(subset.get(), codepoint)));
+  }
+  CHECK(TCOD_tileset_get_tile_id_(subset.get(), 'B') == 0);
+  CHECK(tcod::load_bdf(path, {})->tiles_count == 0);
+}
+
+TEST_CASE("Load BDF errors.") {
+  const std::string header =
+      "STARTFONT 2.1\nFONTBOUNDINGBOX 8 2 0 0\nCHARS 1\nSTARTCHAR A\nENCODING 65\nBBX 8 2 0 0\nBITMAP\n";
+  const auto load = [](const std::string& bdf) {
+    return tcod::TilesetPtr{
+        TCOD_load_bdf_memory(static_cast<int>(bdf.size()), reinterpret_cast<const unsigned char*>(bdf.data()))};
+  };
+  const auto tileset = load(header + "81\r\nFF\r\nENDCHAR\r\nENDFONT\r\n");
+  REQUIRE(tileset);
+  const TCOD_ColorRGBA* tile = TCOD_tileset_get_tile(tileset.get(), 'A');
+  CHECK(tile[0].a == 255);
+  CHECK(tile[1].a == 0);
+  CHECK(tile[7].a == 255);
+  CHECK(tile[8].a == 255);
+  CHECK_FALSE(load(header + "8G\nFF\nENDCHAR\nENDFONT\n"));  // Not hexadecimal.
+  CHECK_FALSE(load(header + "81\nF"));  // Truncated.
+  CHECK_FALSE(load(header + "81\nFF\nENDCHAR\nSTARTCHAR B\nENCODING 66\nENDCHAR\nENDFONT\n"));  // Wrong count.
+  CHECK_FALSE(load(
+      "STARTFONT 2.1\nFONTBOUNDINGBOX 8 2 0 0\nCHARS 1\nSTARTCHAR A\nENCODING 65\nBBX -200 2 0 0\nBITMAP\n"
+      "81\nFF\nENDCHAR\nENDFONT\n"));  // Negative glyph width.
+}
+
+/// Return a tileset with a single noisy tile assigned to 'A'.
+static auto new_render_test_tileset(int tile_width, int tile_height) -> tcod::Tileset {
+  auto tileset = tcod::Tileset{tile_width, tile_height};
+  std::vector<TCOD_ColorRGBA> pixels(tile_width * tile_height);
+  for (int i = 0; i < static_cast<int>(pixels.size()); ++i) {
+    pixels.at(i) = {
+        static_cast<uint8_t>(i * 37), static_cast<uint8_t>(i * 59), static_cast<uint8_t>(i * 83),
+        static_cast<uint8_t>(i * 53)};
+  }
+  REQUIRE(TCOD_tileset_set_tile_(tileset.get(), 'A', pixels.data()) >= 0);
+  return tileset;
+}
+
+TEST_CASE("Render to RGBA") {
+  const int TILE_W = 8;
+  const int TILE_H = 7;
+  auto tileset = new_render_test_tileset(TILE_W, TILE_H);
+  auto console = tcod::Console{16, 16};
+  for (int y = 0; y < console.get_height(); ++y) {
+    for (int x = 0; x < console.get_width(); ++x) {
+      const int i = y * console.get_width() + x;
+      console.at({x, y}) = {
+          i % 3 ? 'A' : ' ',
+          {static_cast<uint8_t>(i * 7), static_cast<uint8_t>(i * 11), static_cast<uint8_t>(i * 13),
+           static_cast<uint8_t>(i % 5 ? 255 : i * 17)},
+          {static_cast<uint8_t>(i * 19), static_cast<uint8_t>(i * 23), static_cast<uint8_t>(i * 29),
+           static_cast<uint8_t>(i % 4 ? 255 : i * 31)},
+      };
+    }
+  }
+  console.at({0, 0}) = {'A', {0, 0, 0, 0}, {0, 0, 0, 0}};  // Fully transparent tile on a transparent background.
+  const int width = console.get_width() * TILE_W;
+  const int height = console.get_height() * TILE_H;
+  std::vector<TCOD_ColorRGBA> pixels(width * height);
+  TCOD_Console* cache = nullptr;
+  REQUIRE(
+      TCOD_tileset_render_to_rgba(
+          tileset.get(), console.get(), &cache, pixels.data(), width * static_cast<int>(sizeof(pixels[0]))) ==
+      TCOD_E_OK);
+  TCOD_console_delete(cache);
+  const TCOD_ColorRGBA* graphic = TCOD_tileset_get_tile(tileset.get(), 'A');
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      // Reference blending with plain integer division.
+      const TCOD_ConsoleTile& tile = console.at({x / TILE_W, y / TILE_H});
+      TCOD_ColorRGBA expected = tile.bg;
+      if (tile.ch == 'A') {
+        const TCOD_ColorRGBA& g = graphic[(y % TILE_H) * TILE_W + x % TILE_W];
+        const TCOD_ColorRGBA fg = {
+            static_cast<uint8_t>(tile.fg.r * g.r / 255),
+            static_cast<uint8_t>(tile.fg.g * g.g / 255),
+            static_cast<uint8_t>(tile.fg.b * g.b / 255),
+            static_cast<uint8_t>(tile.fg.a * g.a / 255)};
+        TCOD_color_alpha_blend(&expected, &fg);
+      }
+      if (pixels.at(y * width + x) != expected) {
+        INFO("x=" << x << " y=" << y);
+        REQUIRE(pixels.at(y * width + x) == expected);
+      }
+    }
+  }
+}
+
+TEST_CASE("Render to RGBA benchmarks", "[.benchmark]") {
+  auto tileset = new_render_test_tileset(16, 16);
+  auto console = tcod::Console{240, 135};
+  for (auto& tile : console) tile = {'A', {255, 255, 255, 255}, {0, 0, 64, 255}};
+  const int width = console.get_width() * tileset.get_tile_width();
+  const int height = console.get_height() * tileset.get_tile_height();
+  std::vector<TCOD_ColorRGBA> pixels(width * height);
+  BENCHMARK("240x135 console, 16x16 tiles, full redraw") {
+    return TCOD_tileset_render_to_rgba(
+        tileset.get(), console.get(), nullptr, pixels.data(), width * static_cast<int>(sizeof(pixels[0])));
+  };
+}
+
+TEST_CASE("Lazy tileset") {
+  struct LazyLog {
+    std::vector<int> requested;
+  };
+  auto tileset = tcod::Tileset{2, 2};
+  LazyLog log;
+  tileset.get()->tile_loader = &log;
+  tileset.get()->on_tile_missing = [](TCOD_Tileset* self, int codepoint) -> int {
+    static_cast<LazyLog*>(self->tile_loader)->requested.push_back(codepoint);
+    if (codepoint == '?') return 0;  // Glyph not in this font.
+    const TCOD_ColorRGBA pixels[4] = {{255, 255, 255, 255}, {}, {}, {255, 255, 255, 255}};
+    return TCOD_tileset_set_tile_(self, codepoint, pixels);
+  };
+  REQUIRE(TCOD_tileset_get_tile(tileset.get(), 'A') == nullptr);
+  auto console = tcod::Console{4, 2};
+  console.at({0, 0}).ch = 'A';
+  console.at({1, 0}).ch = 'B';
+  console.at({2, 0}).ch = 'A';
+  console.at({3, 1}).ch = '?';
+  REQUIRE(TCOD_tileset_request_console_tiles(tileset.get(), console.get()) == TCOD_E_OK);
+  CHECK(log.requested == std::vector<int>{'A', 'B', ' ', '?'});  // Blank tiles are spaces.
+  CHECK(TCOD_tileset_get_tile(tileset.get(), 'A') != nullptr);
+  CHECK(TCOD_tileset_get_tile(tileset.get(), 'B') != nullptr);
+  log.requested.clear();
+  REQUIRE(TCOD_tileset_request_tile(tileset.get(), 'B') == TCOD_E_OK);
+  CHECK(log.requested.empty());
+  REQUIRE(TCOD_tileset_request_tile(tileset.get(), 'C') == TCOD_E_OK);
+  CHECK(log.requested == std::vector<int>{'C'});
+}
+
+TEST_CASE("Tileset batches") {
+  struct BatchLog {
+    std::vector<std::vector<int>> batches;
+    std::vector<int> single;
+  };
+  auto tileset = tcod::Tileset{1, 1};
+  BatchLog log;
+  TCOD_TilesetObserver* batched = TCOD_tileset_observer_new(tileset.get());
+  batched->userdata = &log;
+  batched->on_tiles_changed = [](TCOD_TilesetObserver* self, const int* tile_ids, int count) -> int {
+    static_cast<BatchLog*>(self->userdata)->batches.emplace_back(tile_ids, tile_ids + count);
+    return 0;
+  };
+  TCOD_TilesetObserver* single = TCOD_tileset_observer_new(tileset.get());
+  single->userdata = &log;
+  single->on_tile_changed = [](TCOD_TilesetObserver* self, int tile_id) -> int {
+    static_cast<BatchLog*>(self->userdata)->single.push_back(tile_id);
+    return 0;
+  };
+  const TCOD_ColorRGBA pixel = {255, 255, 255, 255};
+  REQUIRE(TCOD_tileset_set_tile_(tileset.get(), 'A', &pixel) == TCOD_E_OK);
+  REQUIRE(TCOD_tileset_set_tile_(tileset.get(), 'B', &pixel) == TCOD_E_OK);
+  const int tile_a = TCOD_tileset_get_tile_id_(tileset.get(), 'A');
+  const int tile_b = TCOD_tileset_get_tile_id_(tileset.get(), 'B');
+  log = {};
+  TCOD_tileset_begin_batch(tileset.get());
+  REQUIRE(TCOD_tileset_set_tile_(tileset.get(), 'B', &pixel) == TCOD_E_OK);
+  TCOD_tileset_begin_batch(tileset.get());
+  REQUIRE(TCOD_tileset_set_tile_(tileset.get(), 'A', &pixel) == TCOD_E_OK);
+  REQUIRE(TCOD_tileset_set_tile_(tileset.get(), 'B', &pixel) == TCOD_E_OK);
+  REQUIRE(TCOD_tileset_end_batch(tileset.get()) == TCOD_E_OK);
+  CHECK(log.batches.empty());  // Nested batches are sent when the outermost batch ends.
+  CHECK(log.single.empty());
+  REQUIRE(TCOD_tileset_end_batch(tileset.get()) == TCOD_E_OK);
+  REQUIRE(log.batches.size() == 1);
+  CHECK(log.batches.at(0) == std::vector<int>{std::min(tile_a, tile_b), std::max(tile_a, tile_b)});
+  CHECK(log.single == std::vector<int>{std::min(tile_a, tile_b), std::max(tile_a, tile_b)});
+  CHECK(TCOD_tileset_end_batch(tileset.get()) < 0);  // No batch in progress.
+}
+
+TEST_CASE("Tileset cache") {
+  const auto source_path = get_file("fonts/Tamzen5x9r.bdf");
+  auto tileset = tcod::load_bdf(source_path);
+  const auto cache_path = (std::filesystem::temp_directory_path() / "libtcod_tileset_cache.bin").string();
+  REQUIRE(TCOD_tileset_save_cache(tileset.get(), cache_path.c_str(), source_path.c_str()) == TCOD_E_OK);
+  auto loaded = tcod::TilesetPtr{TCOD_tileset_load_cache(cache_path.c_str(), source_path.c_str())};
+  REQUIRE(loaded);
+  CHECK(loaded->tile_width == tileset->tile_width);
+  CHECK(loaded->tile_height == tileset->tile_height);
+  REQUIRE(loaded->tiles_count == tileset->tiles_count);
+  CHECK(std::equal(
+      tileset->pixels, tileset->pixels + tileset->tiles_count * tileset->tile_length, loaded->pixels));
+  const int map_length = std::max(tileset->character_map_length, loaded->character_map_length);
+  int mismatched_codepoints = 0;
+  for (int codepoint = 0; codepoint < map_length; ++codepoint) {
+    if (TCOD_tileset_get_tile_id_(tileset.get(), codepoint) != TCOD_tileset_get_tile_id_(loaded.get(), codepoint)) {
+      ++mismatched_codepoints;
+    }
+  }
+  CHECK(mismatched_codepoints == 0);
+  // A different source invalidates the cache.
+  const auto other_source = get_file("fonts/ucs-fonts/4x6.bdf");
+  CHECK_FALSE(tcod::TilesetPtr{TCOD_tileset_load_cache(cache_path.c_str(), other_source.c_str())});
+  CHECK(tcod::TilesetPtr{TCOD_tileset_load_cache(cache_path.c_str(), nullptr)});
+  std::filesystem::remove(cache_path);
+  CHECK_FALSE(tcod::TilesetPtr{TCOD_tileset_load_cache(cache_path.c_str(), nullptr)});
+}
+
+TEST_CASE("Sparse character map") {
+  auto tileset = tcod::TilesetPtr{TCOD_tileset_new(1, 1)};
+  REQUIRE(tileset);
+  const TCOD_ColorRGBA pixel = {255, 255, 255, 255};
+  REQUIRE(TCOD_tileset_set_tile_(tileset.get(), 0xF0000, &pixel) == TCOD_E_OK);
+  REQUIRE(TCOD_tileset_set_tile_(tileset.get(), 'A', &pixel) == TCOD_E_OK);
+  CHECK(TCOD_tileset_get_tile_id_(tileset.get(), 0xF0000) > 0);
+  CHECK(TCOD_tileset_get_tile_id_(tileset.get(), 'A') > 0);
+  CHECK(TCOD_tileset_get_tile_id_(tileset.get(), 'B') == 0);
+  CHECK(TCOD_tileset_get_tile_id_(tileset.get(), 0xEFFFF) == 0);
+  CHECK(TCOD_tileset_get_tile_id_(tileset.get(), -1) == 0);
+  CHECK(TCOD_tileset_get_tile_id_(tileset.get(), 0x7FFFFFFF) == 0);
+  // Only the pages holding 'A' and U+F0000 are allocated, the others share one empty page.
+  const int pages = tileset->character_map_length / TCOD_CHARMAP_PAGE_LENGTH_;
+  std::set<const int*> distinct_pages(tileset->character_map_pages, tileset->character_map_pages + pages);
+  CHECK(distinct_pages.size() == 3);
+}